@@ -0,0 +1,433 @@
+#include "bTree.h"
+#include "stats.h"
+#include "keyIntern.h"
+
+/**********  Helper functions for a B-tree **********/
+BNode* createBNode( bool isLeaf );
+void freeBNodes( BNode* x );
+int findKeyIndex( BNode* x, char* key, bool* found );
+void splitChild( BNode* x, int i );
+void insertNonFull( BTree* bt, BNode* x, Data* tData );
+Data* removeFromBNode( BNode* x, char* key );
+void fillChild( BNode* x, int i );
+void borrowFromPrev( BNode* x, int i );
+void borrowFromNext( BNode* x, int i );
+void mergeChildren( BNode* x, int i );
+void addBNodeMemory( BNode* x, MemoryUsage* mu );
+
+/* createBTree
+ * input: none
+ * output: a pointer to a BTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Creates a new empty BTree and returns a pointer to it.
+ */
+BTree *createBTree( )
+{
+    BTree* bt = (BTree*)malloc( sizeof(BTree) );
+    bt->root = NULL;
+    bt->size = 0;
+
+    return bt;
+}
+
+/* freeBTree
+ * input: a pointer to a BTree
+ * output: none
+ *
+ * frees the given BTree and all of Data elements
+ */
+void freeBTree( BTree* bt )
+{
+    freeBNodes( bt->root );
+    free( bt );
+}
+
+void freeBNodes( BNode* x )
+{
+    int i;
+    if( x==NULL )
+        return;
+    for( i=0; i<x->numKeys; i++ )
+        freeData( x->data[i] );
+    if( !x->isLeaf ){
+        for( i=0; i<=x->numKeys; i++ )
+            freeBNodes( x->children[i] );
+    }
+    free( x );
+}
+
+/* createBNode
+ * input: whether the node is a leaf
+ * output: BNode*
+ *
+ * Malloc and returns a new empty BNode
+ */
+BNode* createBNode( bool isLeaf )
+{
+    BNode* x = (BNode*)malloc( sizeof(BNode) );
+    STATS_INC( allocations );
+    x->numKeys = 0;
+    x->isLeaf = isLeaf;
+    return x;
+}
+
+/* findKeyIndex
+ * input: a pointer to a BNode, a key, a pointer to a bool
+ * output: the index of the first key in x that is >= key
+ *
+ * Binary searches the node.  *found is set to true if that key is equal to key.
+ */
+int findKeyIndex( BNode* x, char* key, bool* found )
+{
+    int low = 0, high = x->numKeys, mid, cmp;
+
+    *found = false;
+    while( low < high ){
+        mid = (low + high)/2;
+        cmp = strcmp( key, x->keys[mid] );
+        if( cmp==0 ){
+            *found = true;
+            return mid;
+        }
+        else if( cmp < 0 )
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+/**********  Functions for searching a B-tree **********/
+
+/* searchBTree
+ * input: a pointer to a BTree, a Data* tData
+ * output: the Data* stored with the same key as tData or, if no such key exists, NULL
+ */
+Data* searchBTree( BTree* bt, Data* tData )
+{
+    BNode* x = bt->root;
+    bool found;
+    int i;
+
+    while( x!=NULL ){
+        i = findKeyIndex( x, tData->key, &found );
+        if( found )
+            return x->data[i];
+        x = x->isLeaf ? NULL : x->children[i];
+    }
+    return NULL;
+}
+
+/**********  Functions for inserting into a B-tree **********/
+
+/* insertBTree
+ * input: a pointer to a BTree, a Data*
+ * output: none
+ *
+ * Stores the passed Data* in the BTree.  Like insertTree, a Data* whose key is already in the tree is not stored.
+ * Full nodes are split on the way down so the insert never has to walk back up.
+ */
+void insertBTree( BTree* bt, Data* tData )
+{
+    BNode* s;
+
+    if( bt->root==NULL ){
+        bt->root = createBNode( true );
+        bt->root->keys[0] = tData->key;
+        bt->root->data[0] = tData;
+        bt->root->numKeys = 1;
+        bt->size = 1;
+        return;
+    }
+
+    /* the root is full so the tree grows by one level */
+    if( bt->root->numKeys==BTREE_MAX_KEYS ){
+        s = createBNode( false );
+        s->children[0] = bt->root;
+        splitChild( s, 0 );
+        bt->root = s;
+    }
+    insertNonFull( bt, bt->root, tData );
+}
+
+/* insertNonFull
+ * input: a pointer to a BTree, a pointer to a BNode that is not full, a Data*
+ * output: none
+ *
+ * Descends to the leaf where tData belongs, splitting any full child before moving into it
+ */
+void insertNonFull( BTree* bt, BNode* x, Data* tData )
+{
+    bool found;
+    int i, cmp;
+
+    while( true ){
+        i = findKeyIndex( x, tData->key, &found );
+        if( found )
+            return;
+
+        if( x->isLeaf ){
+            memmove( &x->keys[i+1], &x->keys[i], (x->numKeys-i)*sizeof(char*) );
+            memmove( &x->data[i+1], &x->data[i], (x->numKeys-i)*sizeof(Data*) );
+            x->keys[i] = tData->key;
+            x->data[i] = tData;
+            x->numKeys++;
+            bt->size++;
+            return;
+        }
+
+        if( x->children[i]->numKeys==BTREE_MAX_KEYS ){
+            splitChild( x, i );
+            cmp = strcmp( tData->key, x->keys[i] );
+            if( cmp==0 )
+                return;
+            if( cmp > 0 )
+                i++;
+        }
+        x = x->children[i];
+    }
+}
+
+/* splitChild
+ * input: a pointer to a BNode that is not full, the index of a full child
+ * output: none
+ *
+ * Moves the upper half of x->children[i] into a new sibling and its median key up into x
+ */
+void splitChild( BNode* x, int i )
+{
+    BNode* y = x->children[i];
+    BNode* z = createBNode( y->isLeaf );
+    int t = BTREE_MIN_DEGREE;
+
+    z->numKeys = t-1;
+    memcpy( z->keys, &y->keys[t], (t-1)*sizeof(char*) );
+    memcpy( z->data, &y->data[t], (t-1)*sizeof(Data*) );
+    if( !y->isLeaf )
+        memcpy( z->children, &y->children[t], t*sizeof(BNode*) );
+    y->numKeys = t-1;
+
+    memmove( &x->children[i+2], &x->children[i+1], (x->numKeys-i)*sizeof(BNode*) );
+    memmove( &x->keys[i+1], &x->keys[i], (x->numKeys-i)*sizeof(char*) );
+    memmove( &x->data[i+1], &x->data[i], (x->numKeys-i)*sizeof(Data*) );
+    x->children[i+1] = z;
+    x->keys[i] = y->keys[t-1];
+    x->data[i] = y->data[t-1];
+    x->numKeys++;
+}
+
+/**********  Functions for removing from a B-tree **********/
+
+/* removeBTree
+ * input: a pointer to a BTree, a key
+ * output: a Data*
+ *
+ * Remove and returns the Data* with the specified key or NULL if its not in the tree
+ */
+Data* removeBTree( BTree* bt, char* key )
+{
+    Data* ret;
+    BNode* oldRoot;
+
+    if( bt->root==NULL )
+        return NULL;
+
+    ret = removeFromBNode( bt->root, key );
+    if( ret!=NULL )
+        bt->size--;
+
+    /* the root lost its last key so the tree shrinks by one level */
+    if( bt->root->numKeys==0 ){
+        oldRoot = bt->root;
+        bt->root = oldRoot->isLeaf ? NULL : oldRoot->children[0];
+        free( oldRoot );
+    }
+    return ret;
+}
+
+/* removeFromBNode
+ * input: a pointer to a BNode, a key
+ * output: the removed Data* or NULL if the key is not in the subtree
+ *
+ * Every child is topped up to at least BTREE_MIN_DEGREE keys before the search moves into it, so a key can
+ * always be taken out of a leaf without walking back up.
+ */
+Data* removeFromBNode( BNode* x, char* key )
+{
+    bool found, last;
+    int i;
+    Data* ret;
+    BNode* y;
+
+    i = findKeyIndex( x, key, &found );
+
+    if( found ){
+        ret = x->data[i];
+        if( x->isLeaf ){
+            memmove( &x->keys[i], &x->keys[i+1], (x->numKeys-i-1)*sizeof(char*) );
+            memmove( &x->data[i], &x->data[i+1], (x->numKeys-i-1)*sizeof(Data*) );
+            x->numKeys--;
+        }
+        else if( x->children[i]->numKeys >= BTREE_MIN_DEGREE ){
+            /* replace with the previous inorder data and remove that from the left subtree */
+            for( y = x->children[i]; !y->isLeaf; y = y->children[y->numKeys] );
+            x->keys[i] = y->keys[y->numKeys-1];
+            x->data[i] = y->data[y->numKeys-1];
+            removeFromBNode( x->children[i], x->keys[i] );
+        }
+        else if( x->children[i+1]->numKeys >= BTREE_MIN_DEGREE ){
+            /* replace with the next inorder data and remove that from the right subtree */
+            for( y = x->children[i+1]; !y->isLeaf; y = y->children[0] );
+            x->keys[i] = y->keys[0];
+            x->data[i] = y->data[0];
+            removeFromBNode( x->children[i+1], x->keys[i] );
+        }
+        else{
+            /* both neighbours are minimal: merge them around the key and remove it from the merged child */
+            mergeChildren( x, i );
+            removeFromBNode( x->children[i], key );
+        }
+        return ret;
+    }
+
+    if( x->isLeaf )
+        return NULL;
+
+    last = ( i==x->numKeys );
+    if( x->children[i]->numKeys < BTREE_MIN_DEGREE )
+        fillChild( x, i );
+    /* the last child may have been merged into its left sibling */
+    if( last && i > x->numKeys )
+        i--;
+    return removeFromBNode( x->children[i], key );
+}
+
+/* fillChild
+ * input: a pointer to a BNode, the index of a child with BTREE_MIN_DEGREE-1 keys
+ * output: none
+ *
+ * Gives x->children[i] an extra key by borrowing from a sibling or merging with one
+ */
+void fillChild( BNode* x, int i )
+{
+    if( i > 0 && x->children[i-1]->numKeys >= BTREE_MIN_DEGREE )
+        borrowFromPrev( x, i );
+    else if( i < x->numKeys && x->children[i+1]->numKeys >= BTREE_MIN_DEGREE )
+        borrowFromNext( x, i );
+    else if( i < x->numKeys )
+        mergeChildren( x, i );
+    else
+        mergeChildren( x, i-1 );
+}
+
+/* borrowFromPrev and borrowFromNext
+ * input: a pointer to a BNode, the index of a child
+ * output: none
+ *
+ * Rotates one key from a sibling through x into x->children[i]
+ */
+void borrowFromPrev( BNode* x, int i )
+{
+    BNode* child = x->children[i];
+    BNode* sibling = x->children[i-1];
+
+    memmove( &child->keys[1], &child->keys[0], child->numKeys*sizeof(char*) );
+    memmove( &child->data[1], &child->data[0], child->numKeys*sizeof(Data*) );
+    if( !child->isLeaf )
+        memmove( &child->children[1], &child->children[0], (child->numKeys+1)*sizeof(BNode*) );
+
+    child->keys[0] = x->keys[i-1];
+    child->data[0] = x->data[i-1];
+    if( !child->isLeaf )
+        child->children[0] = sibling->children[sibling->numKeys];
+
+    x->keys[i-1] = sibling->keys[sibling->numKeys-1];
+    x->data[i-1] = sibling->data[sibling->numKeys-1];
+
+    child->numKeys++;
+    sibling->numKeys--;
+}
+
+void borrowFromNext( BNode* x, int i )
+{
+    BNode* child = x->children[i];
+    BNode* sibling = x->children[i+1];
+
+    child->keys[child->numKeys] = x->keys[i];
+    child->data[child->numKeys] = x->data[i];
+    if( !child->isLeaf )
+        child->children[child->numKeys+1] = sibling->children[0];
+
+    x->keys[i] = sibling->keys[0];
+    x->data[i] = sibling->data[0];
+
+    memmove( &sibling->keys[0], &sibling->keys[1], (sibling->numKeys-1)*sizeof(char*) );
+    memmove( &sibling->data[0], &sibling->data[1], (sibling->numKeys-1)*sizeof(Data*) );
+    if( !sibling->isLeaf )
+        memmove( &sibling->children[0], &sibling->children[1], sibling->numKeys*sizeof(BNode*) );
+
+    child->numKeys++;
+    sibling->numKeys--;
+}
+
+/* mergeChildren
+ * input: a pointer to a BNode, an index i
+ * output: none
+ *
+ * Merges x->children[i+1] and x->keys[i] into x->children[i] (both children must be minimal)
+ */
+void mergeChildren( BNode* x, int i )
+{
+    BNode* child = x->children[i];
+    BNode* sibling = x->children[i+1];
+
+    child->keys[child->numKeys] = x->keys[i];
+    child->data[child->numKeys] = x->data[i];
+    memcpy( &child->keys[child->numKeys+1], sibling->keys, sibling->numKeys*sizeof(char*) );
+    memcpy( &child->data[child->numKeys+1], sibling->data, sibling->numKeys*sizeof(Data*) );
+    if( !child->isLeaf )
+        memcpy( &child->children[child->numKeys+1], sibling->children, (sibling->numKeys+1)*sizeof(BNode*) );
+    child->numKeys += sibling->numKeys + 1;
+
+    memmove( &x->keys[i], &x->keys[i+1], (x->numKeys-i-1)*sizeof(char*) );
+    memmove( &x->data[i], &x->data[i+1], (x->numKeys-i-1)*sizeof(Data*) );
+    memmove( &x->children[i+1], &x->children[i+2], (x->numKeys-i-1)*sizeof(BNode*) );
+    x->numKeys--;
+
+    free( sibling );
+}
+
+/**********  Functions for measuring the memory of a B-tree **********/
+
+/* memoryUsageBTree
+ * input: a pointer to a BTree
+ * output: the bytes used by the BTree, its BNodes and the Data/keys stored in it
+ *
+ * The unused key and child slots of each BNode are part of its node bytes.
+ */
+MemoryUsage memoryUsageBTree( BTree* bt )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = bt->size;
+    addNodeMemory( &mu, bt, sizeof(BTree) );
+    if( bt->root!=NULL )
+        addBNodeMemory( bt->root, &mu );
+    return mu;
+}
+
+void addBNodeMemory( BNode* x, MemoryUsage* mu )
+{
+    int i;
+
+    addNodeMemory( mu, x, sizeof(BNode) );
+    for( i=0; i<x->numKeys; i++ ){
+        addPayloadMemory( mu, x->data[i], sizeof(Data) );
+        addKeyMemory( mu, x->data[i] );
+    }
+    if( !x->isLeaf ){
+        for( i=0; i<=x->numKeys; i++ )
+            addBNodeMemory( x->children[i], mu );
+    }
+}
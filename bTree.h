@@ -0,0 +1,45 @@
+#ifndef _bTree_h
+#define _bTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "data.h"
+#include "memoryUsage.h"
+
+/* Minimum degree of the B-tree: every node except the root holds between BTREE_MIN_DEGREE-1 and
+ * 2*BTREE_MIN_DEGREE-1 keys.  With 8 a full node's key pointers fill two 64-byte cache lines. */
+#define BTREE_MIN_DEGREE 8
+#define BTREE_MAX_KEYS (2*BTREE_MIN_DEGREE-1)
+
+typedef struct BNode
+{
+    int numKeys;                                /* number of keys currently stored in this node */
+    bool isLeaf;                                /* true if this node has no children */
+    char* keys[BTREE_MAX_KEYS];                 /* data[i]->key, kept inline so a node search only touches the node and the key strings */
+    Data* data[BTREE_MAX_KEYS];                 /* the data stored in the node in sorted order */
+    struct BNode* children[BTREE_MAX_KEYS+1];   /* children[i] holds the keys between keys[i-1] and keys[i] (unused for leaves) */
+}  BNode;
+
+typedef struct BTree
+{
+    BNode* root;            /* the root of this tree (it will be a NULL if the tree is empty) */
+    int size;               /* number of Data* stored in the tree */
+}  BTree;
+
+/**********  Functions for creating/freeing a B-tree **********/
+BTree *createBTree( );
+void freeBTree( BTree* bt );
+
+/**********  Functions for searching a B-tree **********/
+Data* searchBTree( BTree* bt, Data* tData );
+
+/**********  Functions for inserting/removing from a B-tree **********/
+void insertBTree( BTree* bt, Data* tData );
+Data* removeBTree( BTree* bt, char* key );
+
+/**********  Functions for measuring the memory of a B-tree **********/
+MemoryUsage memoryUsageBTree( BTree* bt );
+
+#endif
@@ -0,0 +1,149 @@
+#include "benchHarness.h"
+
+/**********  Helper functions for computing percentiles **********/
+int cmpLatencies( const void* a, const void* b );
+double percentile( uint64_t* sorted, long numSamples, double fraction );
+
+/* benchNanos
+ * input: none
+ * output: nanoseconds on the monotonic clock
+ *
+ * Unlike clock(), this is wall time that never jumps and it is not the sum over every thread.
+ */
+uint64_t benchNanos( )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+double benchSeconds( )
+{
+    return benchNanos( )*1e-9;
+}
+
+/* benchTimerOverhead
+ * input: none
+ * output: the smallest gap (in ns) between two back-to-back benchNanos calls
+ *
+ * This is subtracted from every per-operation sample.
+ */
+uint64_t benchTimerOverhead( )
+{
+    static uint64_t overhead = UINT64_MAX;
+    uint64_t start, end;
+    int i;
+
+    if( overhead!=UINT64_MAX )
+        return overhead;
+    for( i=0; i<10000; i++ ){
+        start = benchNanos( );
+        end = benchNanos( );
+        if( end-start < overhead )
+            overhead = end-start;
+    }
+    return overhead;
+}
+
+/* runBenchCase
+ * input: a BenchCase, the number of operations per repetition, the number of untimed warmup repetitions and
+ *        the number of timed repetitions
+ * output: the latency percentiles, throughput, error count and memory over the timed repetitions
+ *
+ * Every repetition runs setup, then times each of the numOps run calls on its own, then calls validate and
+ * teardown outside the timed region.  Warmup repetitions are run the same way but not recorded.  The memory of
+ * the structure is measured (not timed) before and after the operations of the last repetition.
+ */
+BenchResult runBenchCase( BenchCase* bc, int numOps, int numWarmups, int numReps )
+{
+    BenchResult r;
+    uint64_t* latencies = (uint64_t*)malloc( (long)numOps*numReps*sizeof(uint64_t) );
+    uint64_t overhead = benchTimerOverhead( );
+    uint64_t start, elapsed, totalNanos = 0;
+    TreeStats before, after;
+    MemoryUsage memory;
+    void* state;
+    int rep, i;
+
+    r.numSamples = (long)numOps*numReps;
+    r.errors = 0;
+    memset( &r.stats, 0, sizeof(TreeStats) );
+    resetMemoryUsage( &r.memory );
+    for( rep=-numWarmups; rep<numReps; rep++ ){
+        state = bc->setup( numOps );
+        if( bc->memory!=NULL && rep==numReps-1 )
+            r.memory = bc->memory( state );
+        before = getStats( );
+        for( i=0; i<numOps; i++ ){
+            start = benchNanos( );
+            bc->run( state, i );
+            elapsed = benchNanos( ) - start;
+            elapsed = elapsed > overhead ? elapsed - overhead : 0;
+            if( rep>=0 ){
+                latencies[(long)rep*numOps + i] = elapsed;
+                totalNanos += elapsed;
+            }
+        }
+        if( STATS_ENABLED && rep>=0 ){
+            after = getStats( );
+            after = diffStats( &after, &before );
+            addStats( &r.stats, &after );
+        }
+        if( bc->memory!=NULL && rep==numReps-1 ){
+            memory = bc->memory( state );
+            if( totalMemoryUsage( &memory ) > totalMemoryUsage( &r.memory ) )
+                r.memory = memory;
+        }
+        r.errors += bc->validate( state, numOps );
+        bc->teardown( state );
+    }
+
+    qsort( latencies, r.numSamples, sizeof(uint64_t), cmpLatencies );
+    r.p50 = percentile( latencies, r.numSamples, 0.50 );
+    r.p99 = percentile( latencies, r.numSamples, 0.99 );
+    r.p999 = percentile( latencies, r.numSamples, 0.999 );
+    r.opsPerSec = totalNanos==0 ? 0 : r.numSamples*1e9/totalNanos;
+    r.bytesPerElement = (double)totalMemoryUsage( &r.memory )/numOps;
+    free( latencies );
+    return r;
+}
+
+/* printBenchResult
+ * input: a BenchCase and its result
+ * output: none
+ */
+void printBenchResult( BenchCase* bc, BenchResult* r )
+{
+    printf( "%-20s p50 %8.1lf ns  p99 %8.1lf ns  p999 %9.1lf ns  %12.0lf ops/sec", bc->name, r->p50, r->p99, r->p999, r->opsPerSec );
+    if( r->bytesPerElement > 0 )
+        printf( "  %8.1lf bytes/element", r->bytesPerElement );
+    printf( "\n" );
+    if( r->errors!=0 )
+        printf( "FAILURE - %s found %d errors\n", bc->name, r->errors );
+    if( STATS_ENABLED )
+        printStatsJSON( stdout, bc->name, &r->stats );
+}
+
+int cmpLatencies( const void* a, const void* b )
+{
+    uint64_t x = *(uint64_t*)a, y = *(uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* percentile
+ * input: sorted samples, the number of samples, a fraction in [0,1]
+ * output: the nearest-rank percentile
+ */
+double percentile( uint64_t* sorted, long numSamples, double fraction )
+{
+    long rank;
+
+    if( numSamples==0 )
+        return 0;
+    rank = (long)(fraction*numSamples + 0.5);
+    if( rank < 1 )
+        rank = 1;
+    if( rank > numSamples )
+        rank = numSamples;
+    return (double)sorted[rank-1];
+}
@@ -0,0 +1,43 @@
+#ifndef _benchHarness_h
+#define _benchHarness_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "stats.h"
+#include "memoryUsage.h"
+
+typedef struct BenchCase
+{
+    char* name;                                 /* name printed in the report and used to select the case */
+    void* (*setup)( int numOps );               /* builds the structure and inputs for one repetition (not timed) */
+    void (*run)( void* state, int i );          /* performs the i-th operation (each call is timed on its own) */
+    int (*validate)( void* state, int numOps ); /* returns the number of errors found after a repetition (not timed) */
+    void (*teardown)( void* state );            /* frees everything setup made (not timed) */
+    MemoryUsage (*memory)( void* state );       /* measures the structure being timed (NULL if not measured) */
+}  BenchCase;
+
+typedef struct BenchResult
+{
+    long numSamples;        /* number of timed operations over every repetition */
+    double p50, p99, p999;  /* per-operation latency percentiles (in ns, timer overhead removed) */
+    double opsPerSec;       /* timed operations per second of timed time */
+    int errors;             /* total errors reported by validate */
+    TreeStats stats;        /* counters for the timed operations (all zero unless built with TREE_STATS) */
+    MemoryUsage memory;     /* the larger of the structure's memory before and after the last repetition's operations */
+    double bytesPerElement; /* total memory divided by the number of operations per repetition (0 if not measured) */
+}  BenchResult;
+
+/**********  Functions for reading the clock **********/
+uint64_t benchNanos( );
+double benchSeconds( );
+uint64_t benchTimerOverhead( );
+
+/**********  Functions for running/reporting a benchmark case **********/
+BenchResult runBenchCase( BenchCase* bc, int numOps, int numWarmups, int numReps );
+void printBenchResult( BenchCase* bc, BenchResult* r );
+
+#endif
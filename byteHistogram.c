@@ -0,0 +1,167 @@
+#include "byteHistogram.h"
+
+/*
+ * adds the 8 bytes of the 64-bit word w to the 8 tables starting at table t, one byte per table
+ */
+#define COUNT_WORD( tables, t, w ) \
+    do{ \
+        tables[(t)+0][ (w)       & 0xff ]++; \
+        tables[(t)+1][ (w) >>  8 & 0xff ]++; \
+        tables[(t)+2][ (w) >> 16 & 0xff ]++; \
+        tables[(t)+3][ (w) >> 24 & 0xff ]++; \
+        tables[(t)+4][ (w) >> 32 & 0xff ]++; \
+        tables[(t)+5][ (w) >> 40 & 0xff ]++; \
+        tables[(t)+6][ (w) >> 48 & 0xff ]++; \
+        tables[(t)+7][ (w) >> 56        ]++; \
+    }while( 0 )
+
+/**********  Helper functions for the kernels **********/
+void histogramScalar( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] );
+void histogramMultiTable( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] );
+void countTail( uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_BINS], const unsigned char* bytes, size_t i, size_t end );
+void mergeTables( uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_BINS], uint64_t counts[HISTOGRAM_BINS] );
+
+/**********  Functions for counting bytes **********/
+
+/* byteHistogram
+ * input: an array of bytes, its length, an array of HISTOGRAM_BINS counts
+ * output: none
+ *
+ * Sets counts[b] to the number of times the byte b appears in bytes, using the fastest kernel this CPU supports
+ */
+void byteHistogram( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] )
+{
+    byteHistogramKernel( bestHistogramKernel( ), bytes, length, counts );
+}
+
+/* byteHistogramKernel
+ * input: a kernel (which must be supported), an array of bytes, its length, an array of HISTOGRAM_BINS counts
+ * output: none
+ *
+ * Same as byteHistogram with the given kernel.  Every kernel gives the same counts.
+ */
+void byteHistogramKernel( histogramKernel kernel, const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] )
+{
+    memset( counts, 0, HISTOGRAM_BINS*sizeof(uint64_t) );
+    switch( kernel ){
+        case HISTOGRAM_MULTI_TABLE:
+            histogramMultiTable( bytes, length, counts );
+            break;
+        default:
+            histogramScalar( bytes, length, counts );
+            break;
+    }
+}
+
+/* histogramScalar
+ * input: an array of bytes, its length, an array of HISTOGRAM_BINS zeroed counts
+ * output: none
+ *
+ * One count per byte into a single table.  A run of equal bytes makes every increment wait for the store of
+ * the one before it.
+ */
+void histogramScalar( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] )
+{
+    size_t i;
+
+    for( i=0; i<length; i++ )
+        counts[ bytes[i] ]++;
+}
+
+/* histogramMultiTable
+ * input: an array of bytes, its length, an array of HISTOGRAM_BINS zeroed counts
+ * output: none
+ *
+ * Reads 16 bytes at a time as two 64-bit words and counts byte j of the first word in table j and byte j
+ * of the second word in table 8+j, so up to 16 equal bytes in a row go to 16 different counters.  The tables are added to counts every HISTOGRAM_BLOCK bytes,
+ * which keeps the 32-bit counters from overflowing.
+ */
+void histogramMultiTable( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] )
+{
+    uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_BINS];
+    size_t i, block, end;
+    uint64_t w0, w1;
+
+    for( block=0; block<length; block+=HISTOGRAM_BLOCK ){
+        end = length-block < HISTOGRAM_BLOCK ? length : block+HISTOGRAM_BLOCK;
+        memset( tables, 0, sizeof(tables) );
+        for( i=block; i+16<=end; i+=16 ){
+            memcpy( &w0, bytes+i, sizeof(uint64_t) );
+            memcpy( &w1, bytes+i+8, sizeof(uint64_t) );
+            COUNT_WORD( tables, 0, w0 );
+            COUNT_WORD( tables, 8, w1 );
+        }
+        countTail( tables, bytes, i, end );
+        mergeTables( tables, counts );
+    }
+}
+
+/* countTail
+ * input: the count tables, an array of bytes, the first and one past the last byte to count
+ * output: none
+ *
+ * Counts the bytes left over after the last full word of a kernel, spread over the tables
+ */
+void countTail( uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_BINS], const unsigned char* bytes, size_t i, size_t end )
+{
+    for( ; i<end; i++ )
+        tables[ i%HISTOGRAM_TABLES ][ bytes[i] ]++;
+}
+
+/* mergeTables
+ * input: the count tables, an array of HISTOGRAM_BINS counts
+ * output: none
+ *
+ * Adds the sum of the tables to counts.  Sums fit in 32 bits since a block is at most HISTOGRAM_BLOCK bytes.
+ */
+void mergeTables( uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_BINS], uint64_t counts[HISTOGRAM_BINS] )
+{
+    int b, t;
+    uint32_t sum;
+
+    for( b=0; b<HISTOGRAM_BINS; b++ ){
+        sum = 0;
+        for( t=0; t<HISTOGRAM_TABLES; t++ )
+            sum += tables[t][b];
+        counts[b] += sum;
+    }
+}
+
+/**********  Functions for choosing a kernel **********/
+
+/* bestHistogramKernel
+ * input: none
+ * output: the fastest kernel this CPU supports
+ */
+histogramKernel bestHistogramKernel( )
+{
+    return HISTOGRAM_MULTI_TABLE;
+}
+
+/* isHistogramKernelSupported
+ * input: a kernel
+ * output: true if the kernel was compiled in and this CPU can run it
+ */
+bool isHistogramKernelSupported( histogramKernel kernel )
+{
+    switch( kernel ){
+        case HISTOGRAM_SCALAR:
+        case HISTOGRAM_MULTI_TABLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* histogramKernelName
+ * input: a kernel
+ * output: its name for printing
+ */
+char* histogramKernelName( histogramKernel kernel )
+{
+    char* names[] = { "scalar", "multi-table" };
+
+    if( kernel<0 || kernel>=HISTOGRAM_NUM_KERNELS )
+        return "unknown";
+    return names[kernel];
+}
@@ -0,0 +1,24 @@
+#ifndef _byteHistogram_h
+#define _byteHistogram_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#define HISTOGRAM_BINS 256        /* one bin per byte value */
+#define HISTOGRAM_TABLES 16       /* interleaved count tables, so repeated bytes do not wait on each other's stores */
+#define HISTOGRAM_BLOCK (1<<28)   /* bytes counted into the 32-bit tables before they are added to the 64-bit counts */
+
+typedef enum histogramKernel { HISTOGRAM_SCALAR, HISTOGRAM_MULTI_TABLE, HISTOGRAM_NUM_KERNELS } histogramKernel;
+
+/**********  Functions for counting bytes **********/
+void byteHistogram( const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] );
+void byteHistogramKernel( histogramKernel kernel, const unsigned char* bytes, size_t length, uint64_t counts[HISTOGRAM_BINS] );
+
+/**********  Functions for choosing a kernel **********/
+histogramKernel bestHistogramKernel( );
+bool isHistogramKernelSupported( histogramKernel kernel );
+char* histogramKernelName( histogramKernel kernel );
+
+#endif
@@ -1,22 +1,51 @@
 #include "data.h"
+#include "stats.h"
 
 /* compare
  * input: two Data* variables
  * output: int
  *
- * Uses strcmp to compare the key values of the the Data* variables
+ * Uses strcmp to compare the key values of the the Data* variables.  Data sharing an interned key are
+ * equal without reading the strings.
  */
 int compareData( Data* d1, Data* d2 ){
+    STATS_INC( compares );
+    if( d1->key==d2->key )
+        return 0;
     return strcmp( d1->key, d2->key );
 }
 
+/* createData
+ * input: a verification value, a malloc-ed key (the Data takes it over)
+ * output: a pointer to a Data (this is malloc-ed so must be freed eventually with freeData!)
+ */
+Data* createData( int verification, char* key ){
+    Data* d = (Data*)malloc( sizeof(Data) );
+    initData( d, verification, key );
+    return d;
+}
+
+/* initData
+ * input: a Data* to fill, a verification value, a key
+ * output: none
+ *
+ * Sets every field of d.  The key is marked as not interned (internData marks interned keys), so a Data on the
+ * stack that is used as a search probe is safe to hash and compare.
+ */
+void initData( Data* d, int verification, char* key ){
+    d->verification = verification;
+    d->internedKey = false;
+    d->key = key;
+}
+
 /* freeData
  * input: a Data* variable
  * output: int
  *
- * Frees the Data* type variable
+ * Frees the Data* type variable (an interned key belongs to its KeyTable and is not freed)
  */
 void freeData( Data* d ){
-    free( d->key );
+    if( !d->internedKey )
+        free( d->key );
     free( d );
 }
@@ -9,9 +9,12 @@
 typedef struct Data
 {
     int verification;           /* verification of the key */
+    bool internedKey;           /* key belongs to a KeyTable (see keyIntern.h), so freeData leaves it alone */
     char *key;          /* string representing the key value of the node */
 }  Data;
 
+Data* createData( int verification, char* key );
+void initData( Data* d, int verification, char* key );
 void freeData( Data* d );
 int compareData( Data* d1, Data* d2 );
 
@@ -3,48 +3,255 @@
 #include <stdbool.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <math.h>
 
 #include "data.h"
 #include "tree.h"
 #include "priorityQueue.h"
+#include "frozenTree.h"
+#include "bTree.h"
+#include "flatSegmentTree.h"
+#include "fenwickTree.h"
+#include "dynamicSegmentTree.h"
+#include "intervalTree.h"
+#include "parallelSegmentTree.h"
+#include "moveFile.h"
+#include "benchHarness.h"
+#include "stats.h"
+#include "workload.h"
+#include "treeSnapshot.h"
+#include "byteHistogram.h"
+#include "keyIntern.h"
+#include "shardedMap.h"
+#include "radixSort.h"
 
 /* IMPORTANT: parameters to adjust AVL TREE testing and student feedback  */
 #define MAX_VALUE 27             /* try using 27 for smaller testing; Try 77031 for larger testing */
 #define PRINT_AVL_TREE false     /* set to true to enable printing on AVL trees after inserting all of the data */
 #define PRINT_AVL_ERRORS false   /* set to true to enable printing additional details about errors in your AVL tree balance */
 
+/* parameters for the large benchmarks run by "./driver bench" */
+#define BENCH_KEYS 1000000       /* number of keys inserted into the trees being benchmarked */
+#define BENCH_LOOKUPS 2000000    /* number of random lookups timed for each search structure */
+#define BENCH_COLLATZ_STARTS 1000000 /* the Collatz sequences starting at 2..BENCH_COLLATZ_STARTS are used as keys (~2.2 million) */
+#define BENCH_MOVES 1000000      /* number of random moves generated for the segment tree benchmarks */
+#define BENCH_SWEEP_MOVES 10000000 /* number of random moves generated for the sweep line benchmark */
+#define BENCH_INTERVALS 200000   /* number of random intervals stored for the interval tree benchmark */
+#define BENCH_INTERVAL_QUERIES 20000 /* number of stab and range queries timed for the interval tree benchmark */
+#define BENCH_PARALLEL_MOVES 10000000 /* number of random moves generated for the parallel segment tree benchmark */
+#define BENCH_LOADER_MOVES 10000000 /* number of random moves written to and read back from the benchmark move files */
+#define BENCH_TEXT_FILE "/tmp/ctp-bench-moves.txt"  /* scratch text move file for the loader benchmark */
+#define BENCH_BINARY_FILE "/tmp/ctp-bench-moves.bin" /* scratch binary move file for the loader benchmark */
+#define BENCH_HISTOGRAM_BYTES 200000000 /* length of the Zipfian text counted by each kernel in the byte histogram benchmark */
+#define HISTOGRAM_TEST_BYTES 100003 /* length of the Zipfian text the smoke test counts with every kernel (odd, so the kernels' tails run) */
+#define BENCH_COMPRESS_MOVES 10000000 /* number of random moves whose positions are sorted/deduplicated in the coordinate compression benchmark */
+#define WORKLOAD_KEYS 1000000    /* default number of keys/moves/symbols for "./driver workload" */
+#define WORKLOAD_MAX_LOOKUPS 10000000 /* lookups timed by "./driver workload" (at most one per key) */
+#define WORKLOAD_ZIPF_EXPONENT 0.99 /* exponent of the Zipfian lookups (skewed order) and Huffman symbols */
+#define BENCH_SNAPSHOT_FILE "/tmp/ctp-bench-tree.snap" /* scratch snapshot file for the snapshot benchmark */
+#define SNAPSHOT_TEST_FILE "/tmp/ctp-test-tree.snap"   /* scratch snapshot file for the round trip checks of the tests */
+#define BENCH_INTERN_TREES 4     /* number of trees holding the same keys in the interned key benchmark */
+#define BENCH_SHARD_STARTS 250000 /* the sharded map benchmark inserts the Collatz sequences of this many random starts */
+#define BENCH_SHARDS 16          /* number of shards (trees/locks) compared against a single shard in the sharded map benchmark */
+#define BENCH_SHARD_SAMPLES 10000 /* number of Collatz keys sampled to pick the split keys of the sharded map benchmark */
+#define BENCH_SHARD_SEED 2124    /* thread t of the sharded map benchmark draws its Collatz starts from seed BENCH_SHARD_SEED+t */
+#define SHARD_TEST_SHARDS 4      /* number of shards used by the smoke test of the sharded map */
+#define BENCH_SPLAY_SEED 2124    /* seed of the lookup streams of the splay tree benchmark */
+#define BENCH_SPLAY_STREAMS 4    /* number of lookup streams (Zipf exponents below) in the splay tree benchmark */
+#define INTERN_TEST_KEYS 2000    /* number of keys interned by the smoke test of the key table */
+#define SEGMENT_MIN_THREADS 4    /* the parallel car traversal engine uses at least this many threads so the threaded build is always exercised */
+
 /* IMPORTANT: parameters to adjust HUFFMAN TREE testing and student feedback  */
 #define PRINT_HUFFMAN_TREE false /* set to true to enable printing on Huffman trees */
 
 /* IMPORTANT: parameters to adjust SEGMENT TREE testing and student feedback  */
 #define PRINT_SEGMENT_TREE false /* set to true to enable printing on Segment trees after inserting each line segment */
 
+/**********  Functions for running the large benchmarks **********/
+void runBenchmarks( char* name );
+bool isBenchSelected( char* name, char* bench );
+
+/**********  Functions for running generated workloads at scale **********/
+void runWorkload( int argc, char *argv[] );
+void workloadKeys( char* structure, int numKeys, keyOrder order, uint64_t seed );
+void workloadPQ( int numKeys, uint64_t seed );
+void workloadHuffman( long length, uint64_t seed );
+void workloadMoves( char* structure, int numMoves, uint64_t seed );
+int carTraversalParallelAllCores( double moveSequence[], int numMoves );
+
 /**********  Functions for testing Huffman Tree **********/
 void testHuffmanEncoding( char *str );
+void checkHistogramKernels( unsigned char* bytes, size_t length );
+void benchByteHistogram( long length );
 
 /**********  Functions for testing AVL Tree **********/
 void testAVLTree( );
-void createName( int key, char arr[] );
+void createName( long key, char arr[] );
+
+/**********  Functions for testing persistent AVL Tree **********/
+void testPersistentAVLTree( );
+int countPersistentTreeErrors( TNode* root );
+
+/**********  Functions for testing/benchmarking frozen trees **********/
+void testFrozenTree( );
+int countLongFrozenKeyErrors( );
+void createLongName( int i, char* keyName );
+void benchFrozenTree( int numKeys, int numLookups );
+Data** createBenchData( int numKeys );
+
+/**********  Functions for testing/benchmarking tree snapshots **********/
+void checkTreeSnapshot( Tree* t );
+int countTNodeDifferences( TNode* a, TNode* b, treeType type );
+int countKeyDifferences( TNode* a, TNode* b );
+void benchTreeSnapshot( int numKeys, int numMoves );
+
+/**********  Functions for testing/benchmarking interned keys **********/
+void testKeyInterning( );
+void benchKeyInterning( int numKeys, int numLookups );
+
+/**********  Functions for testing/benchmarking sharded maps **********/
+typedef struct ShardBenchTask
+{
+    ShardedMap* map;        /* the map shared by every thread */
+    int numStarts;          /* Collatz starts are drawn from 2..numStarts */
+    int numWalks;           /* number of starts this thread walks */
+    uint64_t seed;          /* this thread's random seed */
+    Data** inserted;        /* the Data this thread stored (removed again by shardRemoveTask) */
+    int numInserted;        /* number of entries in inserted */
+    int capacity;           /* allocated size of inserted */
+    int errors;             /* removes that returned the wrong Data */
+}  ShardBenchTask;
+
+void testShardedMap( );
+void* shardInsertTask( void* arg );
+void* shardRemoveTask( void* arg );
+void benchShardedMap( int numStarts );
+
+/**********  Functions for testing/benchmarking splay trees **********/
+void testSplayTree( );
+void benchSplayTree( int numKeys, int numLookups );
+int searchDepth( Tree* t, Data* tData );
+
+/**********  Functions for testing/benchmarking B-trees **********/
+void testBTree( );
+int countBTreeErrors( BNode* x, char* low, char* high, int depth, int* leafDepth, bool isRoot );
+void benchBTree( int numStarts );
 
 /**********  Functions for testing Segment Tree **********/
+typedef struct CarTraversalEngine
+{
+    char* name;             /* structure name for "./driver workload" */
+    char* description;      /* name used in the test and benchmark output */
+    int (*run)( double moveSequence[], int numMoves );
+    bool isBenchmarked;     /* timed by benchSegmentTrees (the others have their own benchmarks) */
+}  CarTraversalEngine;
+
+typedef struct MoveSegments
+{
+    double* segmentStartArray;  /* low end of the line segment covered by each move */
+    double* segmentEndArray;    /* high end of the line segment covered by each move */
+    double* points;             /* the sorted unique positions of the car */
+    int numUnique;              /* number of entries in points */
+}  MoveSegments;
+
 void testSegmentTree( char *fileName );
 int carTraversalTree( double moveSequence[], int numMoves );
+int carTraversalFlatTree( double moveSequence[], int numMoves );
+int carTraversalSweep( double moveSequence[], int numMoves );
+int carTraversalOnline( double moveSequence[], int numMoves );
+int carTraversalFenwick( double moveSequence[], int numMoves );
+int carTraversalBatch( double moveSequence[], int numMoves );
+int carTraversalDynamic( double moveSequence[], int numMoves );
+int carTraversalIntervalTree( double moveSequence[], int numMoves );
+int carTraversalParallel( double moveSequence[], int numMoves, int numThreads );
+int carTraversalSnapshot( double moveSequence[], int numMoves );
+int buildSegments( double moveSequence[], int numMoves, double* segmentStartArray, double* segmentEndArray, double* points );
+void createMoveSegments( double moveSequence[], int numMoves, MoveSegments* ms );
+void freeMoveSegments( MoveSegments* ms );
+CarTraversalEngine* findCarTraversalEngine( char* name );
+double* generateMoves( int numMoves );
+void benchSegmentTrees( int numMoves );
+void benchCarTraversalSweep( int numMoves );
+void benchIntervalTree( int numIntervals, int numQueries );
+void benchParallelSegmentTree( int numMoves );
+void benchMoveLoader( int numMoves );
+int overlapIntervalsLinear( Interval* intervals, int numIntervals, double queryLow, double queryHigh, Interval* results, int maxResults );
 void readArray( char* fileName, double** pmoveSequence, int* pprovidedSolution, int* pnumMoves );
+void readArrayScanf( char* fileName, double** pmoveSequence, int* pprovidedSolution, int* pnumMoves );
+void benchCoordinateCompression( int numMoves );
 int removeDuplicates( double* points, int oldSize );
 int cmpDoubles (const void * a, const void * b);
 
+/* every car traversal engine, the first one (the pointer segment tree) is the reference the others are checked against */
+CarTraversalEngine carTraversalEngines[] = {
+    { "segment",  "pointer segment tree",                       carTraversalTree,             true },
+    { "batch",    "pointer segment tree with batch query",      carTraversalBatch,            true },
+    { "flat",     "flat segment tree",                          carTraversalFlatTree,         true },
+    { "fenwick",  "Fenwick tree",                               carTraversalFenwick,          true },
+    { "sweep",    "sweep line",                                 carTraversalSweep,            true },
+    { "online",   "online max coverage",                        carTraversalOnline,           true },
+    { "dynamic",  "dynamic segment tree",                       carTraversalDynamic,          true },
+    { "interval", "interval tree",                              carTraversalIntervalTree,     false },
+    { "parallel", "parallel segment tree",                      carTraversalParallelAllCores, false },
+    { "snapshot", "segment tree reloaded from a snapshot",      carTraversalSnapshot,         false }
+};
+#define NUM_CAR_TRAVERSAL_ENGINES (int)(sizeof(carTraversalEngines)/sizeof(carTraversalEngines[0]))
+
 int main( int argc, char *argv[] )
 {
+    TreeStats stats;
+    char* text;
+
+    /* "./driver bench" runs every benchmark, "./driver bench <name>" runs just one of them */
+    if( argc>1 && strcmp( argv[1], "bench" )==0 ){
+        runBenchmarks( argc>2 ? argv[2] : NULL );
+        if( STATS_ENABLED ){
+            stats = getStats( );
+            printStatsJSON( stderr, "driver bench", &stats );
+        }
+        return 0;
+    }
+    /* "./driver workload <structure> [n] [order] [seed]" runs one structure on a generated workload */
+    if( argc>1 && strcmp( argv[1], "workload" )==0 ){
+        runWorkload( argc, argv );
+        if( STATS_ENABLED ){
+            stats = getStats( );
+            printStatsJSON( stderr, "driver workload", &stats );
+        }
+        return 0;
+    }
+
     /* test the Huffman-Encoding */
     printf("HUFFMAN TREE TEST #1:\n");
     testHuffmanEncoding( "aabacccadadadadda" );
     printf("HUFFMAN TREE TEST #2:\n");
     testHuffmanEncoding( "abcdeeeeeeffffffffffff" );
+    checkHistogramKernels( (unsigned char*)"aabacccadadadadda", 17 );
+    text = generateZipfText( HISTOGRAM_TEST_BYTES, 26, WORKLOAD_ZIPF_EXPONENT, 1 );
+    checkHistogramKernels( (unsigned char*)text, HISTOGRAM_TEST_BYTES );
+    free( text );
 
     /* test the AVL tree */
     printf("AVL TREE TEST:\n");
     testAVLTree( );
 
+    /* test the persistent AVL tree */
+    printf("PERSISTENT AVL TREE TEST:\n");
+    testPersistentAVLTree( );
+
+    /* test the frozen (Eytzinger layout) tree */
+    printf("FROZEN TREE TEST:\n");
+    testFrozenTree( );
+    testKeyInterning( );
+    testShardedMap( );
+    testSplayTree( );
+
+    /* test the B-tree */
+    printf("B-TREE TEST:\n");
+    testBTree( );
+
     /* test the Segment tree */
     printf("SEGMENT TREE TEST #1:\n");
     testSegmentTree( "CTP-Simple01.txt" );
@@ -55,10 +262,358 @@ int main( int argc, char *argv[] )
     printf("SEGMENT TREE TEST #3:\n");
     testSegmentTree( "CTP-Simple03.txt" );
 
+    /* counters go to stderr so the smoke test output stays the same */
+    if( STATS_ENABLED ){
+        stats = getStats( );
+        printStatsJSON( stderr, "driver", &stats );
+    }
     return 0;
 }
 
 
+/**********  Functions for running the large benchmarks **********/
+
+/* runBenchmarks
+ * input: the name of a single benchmark to run or NULL for all of them
+ * output: none
+ */
+void runBenchmarks( char* name ){
+    if( isBenchSelected( name, "frozen" ) ){
+        printf("FROZEN TREE BENCHMARK:\n");
+        benchFrozenTree( BENCH_KEYS, BENCH_LOOKUPS );
+    }
+    if( isBenchSelected( name, "btree" ) ){
+        printf("B-TREE BENCHMARK:\n");
+        benchBTree( BENCH_COLLATZ_STARTS );
+    }
+    if( isBenchSelected( name, "segment" ) ){
+        printf("SEGMENT TREE BENCHMARK:\n");
+        benchSegmentTrees( BENCH_MOVES );
+    }
+    if( isBenchSelected( name, "sweep" ) ){
+        printf("SWEEP LINE BENCHMARK:\n");
+        benchCarTraversalSweep( BENCH_SWEEP_MOVES );
+    }
+    if( isBenchSelected( name, "interval" ) ){
+        printf("INTERVAL TREE BENCHMARK:\n");
+        benchIntervalTree( BENCH_INTERVALS, BENCH_INTERVAL_QUERIES );
+    }
+    if( isBenchSelected( name, "parallel" ) ){
+        printf("PARALLEL SEGMENT TREE BENCHMARK:\n");
+        benchParallelSegmentTree( BENCH_PARALLEL_MOVES );
+    }
+    if( isBenchSelected( name, "loader" ) ){
+        printf("MOVE FILE LOADER BENCHMARK:\n");
+        benchMoveLoader( BENCH_LOADER_MOVES );
+    }
+    if( isBenchSelected( name, "snapshot" ) ){
+        printf("TREE SNAPSHOT BENCHMARK:\n");
+        benchTreeSnapshot( BENCH_KEYS, BENCH_MOVES );
+    }
+    if( isBenchSelected( name, "sharded" ) ){
+        printf("SHARDED MAP BENCHMARK:\n");
+        benchShardedMap( BENCH_SHARD_STARTS );
+    }
+    if( isBenchSelected( name, "splay" ) ){
+        printf("SPLAY TREE BENCHMARK:\n");
+        benchSplayTree( BENCH_KEYS, BENCH_LOOKUPS );
+    }
+    if( isBenchSelected( name, "intern" ) ){
+        printf("INTERNED KEY BENCHMARK:\n");
+        benchKeyInterning( BENCH_KEYS, BENCH_LOOKUPS );
+    }
+    if( isBenchSelected( name, "histogram" ) ){
+        printf("BYTE HISTOGRAM BENCHMARK:\n");
+        benchByteHistogram( BENCH_HISTOGRAM_BYTES );
+    }
+    if( isBenchSelected( name, "compress" ) ){
+        printf("COORDINATE COMPRESSION BENCHMARK:\n");
+        benchCoordinateCompression( BENCH_COMPRESS_MOVES );
+    }
+}
+
+bool isBenchSelected( char* name, char* bench ){
+    return name==NULL || strcmp( name, bench )==0;
+}
+
+
+/**********  Functions for running generated workloads at scale **********/
+
+/* runWorkload
+ * input: the command line
+ * output: none
+ *
+ * "./driver workload <structure> [n] [order] [seed]" where structure is one of
+ *   avl, hash, persistent, frozen, btree, splay  n keys inserted, looked up and removed
+ *   pq                                        n TNodes inserted and removed
+ *   huffman                                   a Zipfian text of n lowercase letters encoded
+ *   segment, batch, flat, fenwick, sweep, online, dynamic, interval, parallel, snapshot
+ *                                             a random walk of n moves (see carTraversalEngines)
+ * order (random, sequential, reverse or skewed) is the insertion order of the keys; skewed also makes the
+ * lookups Zipfian.  The same seed always gives the same workload.
+ */
+void runWorkload( int argc, char *argv[] ){
+    char* structure = argc>2 ? argv[2] : "";
+    long n = argc>3 ? atol( argv[3] ) : WORKLOAD_KEYS;
+    keyOrder order = RANDOM_ORDER;
+    uint64_t seed = argc>5 ? strtoull( argv[5], NULL, 10 ) : 2124;
+
+    if( n<1 || n>2000000000L ){
+        printf( "The workload size must be between 1 and 2000000000.\n" );
+        exit(-1);
+    }
+    if( argc>4 && !parseKeyOrder( argv[4], &order ) ){
+        printf( "Unknown key order %s (use random, sequential, reverse or skewed).\n", argv[4] );
+        exit(-1);
+    }
+
+    printf( "WORKLOAD: %s, n = %ld, order = %s, seed = %llu\n", structure, n, keyOrderName( order ), (unsigned long long)seed );
+    if( strcmp( structure, "avl" )==0 || strcmp( structure, "hash" )==0 || strcmp( structure, "persistent" )==0
+        || strcmp( structure, "frozen" )==0 || strcmp( structure, "btree" )==0 || strcmp( structure, "splay" )==0 )
+        workloadKeys( structure, (int)n, order, seed );
+    else if( strcmp( structure, "pq" )==0 )
+        workloadPQ( (int)n, seed );
+    else if( strcmp( structure, "huffman" )==0 )
+        workloadHuffman( n, seed );
+    else
+        workloadMoves( structure, (int)n, seed );
+}
+
+/* workloadKeys
+ * input: the name of a key based structure, the number of keys, the insertion order, a seed
+ * output: none
+ *
+ * Times inserting every key, looking keys up and removing every key (validation is not timed)
+ */
+void workloadKeys( char* structure, int numKeys, keyOrder order, uint64_t seed ){
+    int* keyOrder = generateKeyOrder( numKeys, order, seed );
+    int numLookups = numKeys < WORKLOAD_MAX_LOOKUPS ? numKeys : WORKLOAD_MAX_LOOKUPS;
+    char (*lookupKeys)[31] = malloc( numLookups*sizeof( *lookupKeys ) );
+    Data** allData = (Data**)malloc( numKeys*sizeof(Data*) );
+    bool isBTree = strcmp( structure, "btree" )==0;
+    bool isPersistent = strcmp( structure, "persistent" )==0;
+    bool isFrozen = strcmp( structure, "frozen" )==0;
+    ZipfGenerator* zipf = order==SKEWED_ORDER ? createZipfGenerator( numKeys, WORKLOAD_ZIPF_EXPONENT, seed+1 ) : NULL;
+    uint64_t lookupSeed = seed+1;
+    Tree *pt = NULL, *next;
+    BTree* bt = NULL;
+    FrozenTree* ft = NULL;
+    TreeIterator it;
+    TNode *x, *prev = NULL;
+    Data query, *removed;
+    double start, insertTime, lookupTime, removeTime = 0, freezeTime = 0;
+    int i, found = 0, numRemoved = 0, errors = 0;
+
+    for( i=0; i<numKeys; i++ ){
+        allData[i] = createData( keyOrder[i], (char*)malloc( 31*sizeof(char) ) );
+        createName( keyOrder[i]+1L, allData[i]->key );
+    }
+    /* lookups are uniform over every key, or Zipfian (over key ranks) for the skewed order */
+    for( i=0; i<numLookups; i++ )
+        createName( (zipf!=NULL ? nextZipf( zipf ) : (int)(nextRandom( &lookupSeed ) % numKeys))+1L, lookupKeys[i] );
+
+    if( isBTree )
+        bt = createBTree( );
+    else{
+        pt = createTree( );
+        pt->type = isPersistent ? PERSISTENT : strcmp( structure, "splay" )==0 ? SPLAY : AVL;
+        if( strcmp( structure, "hash" )==0 )
+            enableHashIndex( pt );
+    }
+
+    start = benchSeconds( );
+    for( i=0; i<numKeys; i++ ){
+        if( isBTree )
+            insertBTree( bt, allData[i] );
+        else if( isPersistent ){
+            next = insertTreePersistent( pt, allData[i] );
+            freeTree( pt );
+            pt = next;
+        }
+        else
+            insertTreeBalanced( pt, allData[i] );
+    }
+    insertTime = benchSeconds( ) - start;
+
+    /* every key must come back out in increasing order (PERSISTENT trees have no parent pointers to iterate with) */
+    if( isBTree )
+        errors += bt->size!=numKeys;
+    else if( isPersistent )
+        errors += countPersistentTreeErrors( pt->root );
+    else{
+        initTreeIterator( &it, pt->root );
+        for( i=0; (x = nextTreeIterator( &it ))!=NULL; i++ ){
+            if( prev!=NULL && compareData( prev->data, x->data )>=0 )
+                errors++;
+            prev = x;
+        }
+        errors += i!=numKeys;
+    }
+
+    if( isFrozen ){
+        start = benchSeconds( );
+        ft = freezeTree( pt );
+        freezeTime = benchSeconds( ) - start;
+    }
+
+    start = benchSeconds( );
+    for( i=0; i<numLookups; i++ ){
+        initData( &query, -1, lookupKeys[i] );
+        if( isBTree )
+            found += searchBTree( bt, &query )!=NULL;
+        else if( isFrozen )
+            found += searchFrozenTree( ft, &query )!=NULL;
+        else
+            found += searchTree( pt, &query )!=NULL;
+    }
+    lookupTime = benchSeconds( ) - start;
+    errors += found!=numLookups;
+
+    if( ft!=NULL )
+        freeFrozenTree( ft );
+    start = benchSeconds( );
+    for( i=0; i<numKeys; i++ ){
+        if( isBTree )
+            removed = removeBTree( bt, allData[i]->key );
+        else if( isPersistent ){
+            next = removeTreePersistent( pt, allData[i]->key, &removed );
+            freeTree( pt );
+            pt = next;
+        }
+        else
+            removed = removeTree( pt, allData[i]->key );
+        if( removed!=NULL ){
+            numRemoved++;
+            freeData( removed ); /* allData[i] itself */
+        }
+    }
+    removeTime = benchSeconds( ) - start;
+    errors += numRemoved!=numKeys;
+
+    printf( "Insert %d keys (in seconds): %lf, %.1lf ns/key\n", numKeys, insertTime, 1e9*insertTime/numKeys );
+    if( isFrozen )
+        printf( "Freeze (in seconds): %lf\n", freezeTime );
+    printf( "%s lookups %d (in seconds): %lf, %.1lf ns/lookup\n", zipf!=NULL ? "Zipfian" : "Uniform", numLookups, lookupTime, 1e9*lookupTime/numLookups );
+    printf( "Remove %d keys (in seconds): %lf, %.1lf ns/key\n", numKeys, removeTime, 1e9*removeTime/numKeys );
+    if( errors!=0 )
+        printf( "FAILURE - %d errors in the %s workload\n", errors, structure );
+    printf( "\n" );
+
+    if( isBTree )
+        freeBTree( bt );
+    else
+        freeTree( pt );
+    if( zipf!=NULL )
+        freeZipfGenerator( zipf );
+    free( allData );
+    free( lookupKeys );
+    free( keyOrder );
+}
+
+/* workloadPQ
+ * input: the number of TNodes, a seed
+ * output: none
+ *
+ * Times inserting TNodes with random priorities into a PriorityQueue and removing them all again
+ */
+void workloadPQ( int numKeys, uint64_t seed ){
+    TNode** nodes = (TNode**)malloc( numKeys*sizeof(TNode*) );
+    PriorityQueue* ppq = createPQ( );
+    double start, insertTime, removeTime;
+    int i, errors = 0, last = -1;
+
+    for( i=0; i<numKeys; i++ ){
+        nodes[i] = createTNode( );
+        nodes[i]->priority = nextRandom( &seed ) % 1000000000;
+    }
+
+    start = benchSeconds( );
+    for( i=0; i<numKeys; i++ )
+        insertPQ( ppq, nodes[i] );
+    insertTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    for( i=0; i<numKeys; i++ )
+        nodes[i] = removePQ( ppq );
+    removeTime = benchSeconds( ) - start;
+
+    for( i=0; i<numKeys; i++ ){
+        if( nodes[i]->priority < last )
+            errors++;
+        last = nodes[i]->priority;
+        free( nodes[i] );
+    }
+    printf( "Insert %d TNodes (in seconds): %lf, %.1lf ns/insert\n", numKeys, insertTime, 1e9*insertTime/numKeys );
+    printf( "Remove %d TNodes (in seconds): %lf, %.1lf ns/remove\n", numKeys, removeTime, 1e9*removeTime/numKeys );
+    if( errors!=0 || !isEmptyPQ( ppq ) )
+        printf( "FAILURE - %d TNodes came out of the priority queue out of order\n", errors );
+    printf( "\n" );
+
+    freePQ( ppq );
+    free( nodes );
+}
+
+/* workloadHuffman
+ * input: the length of the text, a seed
+ * output: none
+ *
+ * Encodes a Zipfian text over the 26 lowercase letters with testHuffmanEncoding
+ */
+void workloadHuffman( long length, uint64_t seed ){
+    char* text = generateZipfText( length, 26, WORKLOAD_ZIPF_EXPONENT, seed );
+    double start = benchSeconds( );
+
+    testHuffmanEncoding( text );
+    printf( "Huffman encoding of %ld symbols (in seconds): %lf\n\n", length, benchSeconds( ) - start );
+    free( text );
+}
+
+/* workloadMoves
+ * input: the name of a car traversal engine, the number of moves, a seed
+ * output: none
+ *
+ * Times one car traversal engine on a random walk and checks it against the sweep line (not timed)
+ */
+void workloadMoves( char* structure, int numMoves, uint64_t seed ){
+    CarTraversalEngine* engine = findCarTraversalEngine( structure );
+    double* moveSequence;
+    double start, elapsed;
+    int solution, expected;
+
+    if( engine==NULL ){
+        printf( "Unknown structure %s.\n", structure );
+        exit(-1);
+    }
+
+    moveSequence = generateRandomWalk( numMoves, seed );
+    start = benchSeconds( );
+    solution = engine->run( moveSequence, numMoves );
+    elapsed = benchSeconds( ) - start;
+
+    printf( "Max coverage of %d moves: %d\n", numMoves, solution );
+    printf( "Time (in seconds): %lf, %.1lf ns/move\n", elapsed, 1e9*elapsed/numMoves );
+    if( engine->run!=carTraversalSweep ){
+        expected = carTraversalSweep( moveSequence, numMoves );
+        if( expected!=solution )
+            printf( "FAILURE - the sweep line computed a solution of %d\n", expected );
+    }
+    printf( "\n" );
+    free( moveSequence );
+}
+
+/* carTraversalParallelAllCores
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * carTraversalParallel with one thread per online core (but at least SEGMENT_MIN_THREADS)
+ */
+int carTraversalParallelAllCores( double moveSequence[], int numMoves ){
+    int numThreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+
+    return carTraversalParallel( moveSequence, numMoves, numThreads<SEGMENT_MIN_THREADS ? SEGMENT_MIN_THREADS : numThreads );
+}
+
+
 /**********  Functions for testing Huffman Encoding **********/
 
 /* testHuffmanEncoding
@@ -69,20 +624,18 @@ int main( int argc, char *argv[] )
  */
 void testHuffmanEncoding( char *str ){
     int i, charCounts[26], length = strlen(str);
+    uint64_t byteCounts[HISTOGRAM_BINS];
     bool flag = false;
     TNode* root;
     Tree* pt;
     PriorityQueue* ppq = createPQ();
 
     /* Compute frequency (i.e. # instances) of each lowercase character */
-    for( i=0; i<26; i++ )
-        charCounts[i]=0;
-
-    for( i=0; i<length; i++ ){
-        if( 'a' <= str[i] && str[i] <= 'z' ){
-            charCounts[ str[i]-'a' ]++;
+    byteHistogram( (unsigned char*)str, length, byteCounts );
+    for( i=0; i<26; i++ ){
+        charCounts[i] = byteCounts['a'+i];
+        if( charCounts[i]>0 )
             flag = true;
-        }
     }
 
     if( !flag ){
@@ -95,7 +648,7 @@ void testHuffmanEncoding( char *str ){
         if( charCounts[i]>0 ){
             root = createTNode( );
 
-            root->str = (char*)malloc( (length+1)*sizeof(char) );
+            root->str = (char*)malloc( 27*sizeof(char) ); /* a subtree holds at most the 26 lowercase letters */
             root->priority = charCounts[i];
             root->str[0] = 'a'+i;
             root->str[1] = '\0';
@@ -109,7 +662,7 @@ void testHuffmanEncoding( char *str ){
         TNode* min2 = removePQ( ppq );
 
         root = (TNode*)malloc( sizeof(TNode) );
-        root->str = (char*)malloc( (length+1)*sizeof(char) );
+        root->str = (char*)malloc( 27*sizeof(char) );
         root->priority = min1->priority + min2->priority;
         root->str[0] = '\0';
         root->pParent = NULL; //No parent since this is a root of a subtree
@@ -140,11 +693,74 @@ void testHuffmanEncoding( char *str ){
         }
     }
     printf("\n");
+    checkTreeSnapshot( pt );
 
     freeTree( pt );
     freePQ( ppq );
 }
 
+/* checkHistogramKernels
+ * input: an array of bytes, its length
+ * output: none
+ *
+ * Counts the bytes with byteHistogram and again with every kernel this CPU supports and prints a FAILURE for
+ * any that disagrees.  Only the smoke test calls this, so the Huffman encoder counts its input once.
+ */
+void checkHistogramKernels( unsigned char* bytes, size_t length ){
+    uint64_t counts[HISTOGRAM_BINS], kernelCounts[HISTOGRAM_BINS];
+    histogramKernel k;
+
+    byteHistogram( bytes, length, counts );
+    for( k=0; k<HISTOGRAM_NUM_KERNELS; k++ ){
+        if( !isHistogramKernelSupported( k ) )
+            continue;
+        byteHistogramKernel( k, bytes, length, kernelCounts );
+        if( memcmp( counts, kernelCounts, sizeof(kernelCounts) )!=0 )
+            printf("FAILURE - the %s histogram kernel gave different byte counts\n", histogramKernelName( k ));
+    }
+}
+
+/* benchByteHistogram
+ * input: the length of the text to count
+ * output: none
+ *
+ * Times every supported histogram kernel on a Zipfian lowercase text (the Huffman workload) and on a run of
+ * one repeated byte, and checks every kernel gives the scalar counts
+ */
+void benchByteHistogram( long length ){
+    char* text = generateZipfText( length, 26, WORKLOAD_ZIPF_EXPONENT, 1 );
+    char* run = (char*) malloc( length );
+    char* inputs[] = { text, run };
+    char* inputNames[] = { "Zipfian text", "one repeated byte" };
+    uint64_t counts[HISTOGRAM_BINS], scalarCounts[HISTOGRAM_BINS];
+    double start, elapsed, scalarTime = 0;
+    histogramKernel k;
+    int i;
+
+    memset( run, 'a', length );
+    for( i=0; i<2; i++ ){
+        printf( "%s of %ld bytes (best kernel: %s):\n", inputNames[i], length, histogramKernelName( bestHistogramKernel( ) ) );
+        for( k=0; k<HISTOGRAM_NUM_KERNELS; k++ ){
+            if( !isHistogramKernelSupported( k ) )
+                continue;
+            start = benchSeconds( );
+            byteHistogramKernel( k, (unsigned char*)inputs[i], length, counts );
+            elapsed = benchSeconds( ) - start;
+            if( k==HISTOGRAM_SCALAR ){
+                scalarTime = elapsed;
+                memcpy( scalarCounts, counts, sizeof(counts) );
+            }
+            else if( memcmp( scalarCounts, counts, sizeof(counts) )!=0 )
+                printf( "FAILURE - the %s histogram kernel gave different byte counts\n", histogramKernelName( k ) );
+            printf( "%-12s time (in seconds): %lf, %.2lf GB/s, speedup: %.2lfx\n", histogramKernelName( k ), elapsed, length/elapsed/1e9, scalarTime/elapsed );
+        }
+    }
+    printf( "\n" );
+
+    free( text );
+    free( run );
+}
+
 
 /**********  Functions for testing AVL-Tree **********/
 
@@ -165,32 +781,50 @@ int countAVLTreeErrors(TNode* root){
 }
 
 void testAVLTree( ){
-    int i = 0;
+    int i = 0, j, numKeys, numQueries;
+    TreeIterator it;
+    TNode *x, *prev;
     char testData[31];
-    Data *temp;
-    clock_t start, end;
+    char* queryKeys;
+    Data *temp, *queries;
+    double start, elapsed;
     int errorCnt = 0;
     int dataLostCnt = 0;
 
     Tree* pt = createTree();
     pt->type = AVL;
+    enableHashIndex( pt );
 
-    /* Time the insert function */
-    start = clock();
+    /* Time the insert function (only the insertTreeBalanced calls, not the checks after each one) */
+    elapsed = 0;
     for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
-        temp = (Data *)malloc( sizeof(Data) );
-        temp->verification = i;
-        temp->key = (char*)malloc( 31*sizeof(char) );
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
         createName( i, temp->key );
+        start = benchSeconds( );
         insertTreeBalanced( pt, temp );
+        elapsed += benchSeconds( ) - start;
         if( PRINT_AVL_ERRORS )
             checkAVLTree( pt->root );
         errorCnt += countAVLTreeErrors( pt->root );
         if( searchTree( pt, temp )==NULL )
             dataLostCnt++;
     }
-    end = clock();
-    printf( "Time to insert (in seconds): %lf\n" , (double)(end - start) / CLOCKS_PER_SEC );
+    printf( "Time to insert (in seconds): %lf\n" , elapsed );
+
+    /* The in-order iterator must visit every key exactly once in increasing order */
+    initTreeIterator( &it, pt->root );
+    prev = NULL;
+    numKeys = 0;
+    while( (x = nextTreeIterator( &it ))!=NULL ){
+        if( prev!=NULL && compareData( prev->data, x->data )>=0 )
+            errorCnt++;
+        prev = x;
+        numKeys++;
+    }
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1)
+        numKeys--;
+    if( numKeys!=0 )
+        errorCnt++;
     if( errorCnt!= 0 )
         printf( "FAILURE - # errors in AVL tree structure = %d\n" , errorCnt );
     if( dataLostCnt!=0 )
@@ -200,15 +834,39 @@ void testAVLTree( ){
         printTreeByType( pt, pt->root, 0 );
     }
 
+    /* Every key must be found walking the tree (searchTreeRec) and through the hash index (searchTree), with
+     * queries that do not share the stored keys (lookup latency is timed by "./driver bench intern") */
+    numQueries = 0;
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1)
+        numQueries++;
+    queryKeys = (char*)malloc( numQueries*31*sizeof(char) );
+    queries = (Data*)malloc( numQueries*sizeof(Data) );
+    for( i=MAX_VALUE, j=0; i!=1; i= i%2==0 ? i/2 : i*3+1, j++){
+        initData( &queries[j], i, &queryKeys[31*j] );
+        createName( i, queries[j].key );
+    }
+    for( j=0; j<numQueries; j++ ){
+        if( searchTreeRec( pt->root, &queries[j] )==NULL )
+            dataLostCnt++;
+        if( searchTree( pt, &queries[j] )==NULL )
+            dataLostCnt++;
+    }
+    if( dataLostCnt!=0 )
+        printf( "FAILURE - # AVL tree lookups that missed = %d\n" , dataLostCnt );
+    free( queries );
+    free( queryKeys );
+
     errorCnt = 0;
     dataLostCnt = 0;
 
-    /* Time the remove function */
-    start = clock();
+    /* Time the remove function (only the first removeTree of each key, not the checks) */
+    elapsed = 0;
     for( i=MAX_VALUE; i!=1; i=(i%2==0) ? i/2 : i*3+1){
         createName( i, testData );
 
+        start = benchSeconds( );
         temp = removeTree( pt, testData );
+        elapsed += benchSeconds( ) - start;
         if( temp==NULL )
             printf( "NULL returned for: %s\n", testData );
         else if( temp->verification!=i ){
@@ -229,8 +887,7 @@ void testAVLTree( ){
         }
         errorCnt += countAVLTreeErrors( pt->root );
     }
-    end = clock();
-    printf( "Time to remove (in seconds): %lf\n" , (double)(end - start) / CLOCKS_PER_SEC );
+    printf( "Time to remove (in seconds): %lf\n" , elapsed );
     if( errorCnt!= 0 )
         printf( "FAILURE - # errors in AVL tree structure = %d\n" , errorCnt );
 
@@ -239,7 +896,7 @@ void testAVLTree( ){
     printf("\n");
 }
 
-void createName( int freq, char *keyName ){
+void createName( long freq, char *keyName ){
     int i;
     bool b = true;
     for( i=29; i>=0; i-- ){
@@ -256,117 +913,1500 @@ void createName( int freq, char *keyName ){
 }
 
 
-/**********  Functions for testing Segment Tree **********/
-
-void testSegmentTree( char *fileName ){
-    double *moveSequence;
-    int providedSolution, computedSolution;
-    int numMoves;
+/**********  Functions for testing persistent AVL-Tree **********/
 
-    readArray( fileName, &moveSequence, &providedSolution, &numMoves );
-    computedSolution = carTraversalTree( moveSequence, numMoves );
+/* countPersistentTreeErrors
+ * input: the root of a PERSISTENT tree
+ * output: the number of unbalanced nodes or nodes with a wrong height
+ *
+ * PERSISTENT trees have no parent pointers so countAVLTreeErrors can't be used on them
+ */
+int countPersistentTreeErrors( TNode* root ){
+    int cnt = 0, left, right;
+    if( root!=NULL ){
+        left = root->pLeft==NULL ? 0 : root->pLeft->height;
+        right = root->pRight==NULL ? 0 : root->pRight->height;
+        if( getBalance(root)>1 || getBalance(root)<-1 )
+            cnt++;
+        if( root->height != (left>right ? left : right) + 1 )
+            cnt++;
 
-    printf( "Your segment tree computed a solution of %d\n", computedSolution );
-    if( providedSolution!=-1 && computedSolution==providedSolution ){
-        printf( "Your algorithm worked correctly (i.e. same as provided solution)\n" );
-    }
-    else if( providedSolution!=-1){
-        printf( "Your algorithm did not match the provided solution of %d.\n", providedSolution );
+        cnt += countPersistentTreeErrors(root->pLeft);
+        cnt += countPersistentTreeErrors(root->pRight);
     }
-    printf("\n");
+    return cnt;
 }
 
-void readArray( char *fileName, double** pmoveSequence, int* pprovidedSolution, int* pnumMoves ){
-    double* moveSequence;
+/* testPersistentAVLTree
+ * input: none
+ * output: none
+ *
+ * Inserts the same keys as testAVLTree into a PERSISTENT tree, takes an O(1) snapshot and then removes every key.
+ * The snapshot must still contain every key after all of the removes.
+ */
+void testPersistentAVLTree( ){
+    int i, numKeys = 0, errorCnt = 0, dataLostCnt = 0;
+    char testData[31];
+    Data *temp, *removed;
+    Data **allData;
+    Tree *pt, *next, *snapshot;
 
-    *pnumMoves = 0;
-    *pprovidedSolution = -1;
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1)
+        numKeys++;
+    allData = (Data **)malloc( numKeys*sizeof(Data*) );
 
-    int i;
+    pt = createTree();
+    pt->type = PERSISTENT;
 
-    if( fileName != NULL ){
-        FILE *in_file = fopen(fileName, "r");
+    numKeys = 0;
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        createName( i, temp->key );
+        allData[numKeys++] = temp;
 
-        if(in_file == NULL)
-        {
-            printf("File %s not found.\n", fileName);
-            exit(-1);
-        }
+        next = insertTreePersistent( pt, temp );
+        freeTree( pt );
+        pt = next;
+        errorCnt += countPersistentTreeErrors( pt->root );
+        if( searchTree( pt, temp )==NULL )
+            dataLostCnt++;
+    }
 
-        /* read the number of nodes from file and allocate space to store them */
-        if( fscanf( in_file, "%d%d", pnumMoves, pprovidedSolution ) != 2 )
-        {
-            printf( "Invalid file format.  First line should be number of moves followed by the correct solution (or -1 if none is provided)\n");
-            exit(-1);
-        }
-        if( *pnumMoves < 0 )
-        {
-            printf( "The number moves must be non-negative.\n");
-            exit(-1);
-        }
+    snapshot = snapshotTree( pt );
 
-        (*pmoveSequence) = (double*) malloc( (*pnumMoves)*sizeof( double ) );
-        moveSequence = (*pmoveSequence);
-        /* read in names of nodes */
-        for( i=0 ; i<(*pnumMoves); i++)
-        {
-            if( fscanf( in_file, "%lf", &moveSequence[i] ) == 0 )
-            {
-                printf( "Failed to read %dth double in the move sequence", i );
-                exit(-1);
-            }
-        }
-        fclose( in_file );
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        createName( i, testData );
+        next = removeTreePersistent( pt, testData, &removed );
+        if( removed==NULL || removed->verification!=i )
+            printf( "Wrong value returned for: %s\n", testData );
+        else if( searchTree( pt, removed )==NULL ) /* the old version must be unchanged */
+            dataLostCnt++;
+        freeTree( pt );
+        pt = next;
+        errorCnt += countPersistentTreeErrors( pt->root );
     }
-}
+    if( pt->root!=NULL )
+        printf( "FAILURE - persistent tree not empty after removing every key\n" );
 
-int carTraversalTree( double moveSequence[], int numMoves ){
-    double current = 0, next = 0;
-    int i, max;
-    double* segmentStartArray = (double*) malloc( numMoves*sizeof( double ) );
-    double* segmentEndArray = (double*) malloc( numMoves*sizeof( double ) );
-    double* points = (double*) malloc( (numMoves+1)*sizeof( double ) );
-    Tree* pt;
-    TNode* root;
+    for( i=0; i<numKeys; i++ ){
+        if( searchTree( snapshot, allData[i] )==NULL )
+            dataLostCnt++;
+    }
+    errorCnt += countPersistentTreeErrors( snapshot->root );
 
-    points[0] = 0;
-    for( i=0 ; i<numMoves; i++)
-    {
-        current = next;
-        next = next + moveSequence[i];
+    if( errorCnt!= 0 )
+        printf( "FAILURE - # errors in persistent AVL tree structure = %d\n" , errorCnt );
+    if( dataLostCnt!=0 )
+        printf( "FAILURE - # persistent AVL tree elements lost from an older version = %d\n" , dataLostCnt );
+    else
+        printf( "Snapshot still holds all %d keys after removing them from the newest version\n", numKeys );
 
-        if( current < next ){
-            segmentStartArray[i] = current;
-            segmentEndArray[i] = next;
-        }
-        else{
-            segmentStartArray[i] = next;
-            segmentEndArray[i] = current;
-        }
-        points[i+1] = next;
-    }
+    /* the Data is shared by every version, so free it once all versions are gone */
+    freeTree( pt );
+    freeTree( snapshot );
+    for( i=0; i<numKeys; i++ )
+        freeData( allData[i] );
+    free( allData );
+    printf("\n");
+}
 
-    /* Sort the points and remove all duplicates */
-    qsort( points, numMoves+1, sizeof(double), cmpDoubles );
-    int numUnique = removeDuplicates( points, numMoves+1 );
 
-    /* build the segment tree */
-    root = constructSegmentTree( points, 0, numUnique-1 );
-    pt = createTreeFromTNode( root );
-    pt->type = SEGMENT;
+/**********  Functions for testing/benchmarking frozen trees **********/
 
-    if( PRINT_SEGMENT_TREE ){
-        printf("\nSEGMENT TREE - before inserting any line segments:\n" );
-        printTreeByType( pt, pt->root, 0 );
-        printf("\n");
+/* testFrozenTree
+ * input: none
+ * output: none
+ *
+ * Freezes an AVL tree holding the testAVLTree keys and checks every key (and a missing key) can be found,
+ * then does the same for keys longer than the inline bytes of a FrozenNode
+ */
+void testFrozenTree( ){
+    int i, numKeys = 0, dataLostCnt = 0;
+    char testData[31];
+    Data *temp, missing;
+    Tree* pt = createTree();
+    FrozenTree *ft, *snapshotFrozen;
+    TreeSnapshot* ts;
+    pt->type = AVL;
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        createName( i, temp->key );
+        insertTreeBalanced( pt, temp );
+        numKeys++;
     }
-    /* insert the line segments */
-    for( i=0 ; i<numMoves; i++){
-        insertSegment( root, segmentStartArray[i], segmentEndArray[i] );
 
-        if( PRINT_SEGMENT_TREE ){
-            printf("SEGMENT TREE - after inserting the line segment (%0.2lf,%0.2lf):\n", segmentStartArray[i], segmentEndArray[i] );
-            printTreeByType( pt, pt->root, 0 );
+    /* the same keys frozen straight from a snapshot of the tree */
+    checkTreeSnapshot( pt );
+    writeTreeSnapshot( SNAPSHOT_TEST_FILE, pt );
+    ts = openTreeSnapshot( SNAPSHOT_TEST_FILE );
+    snapshotFrozen = freezeTreeSnapshot( ts );
+
+    ft = freezeTree( pt );
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        createName( i, testData );
+        initData( &missing, -1, testData );
+        temp = searchFrozenTree( ft, &missing );
+        if( temp==NULL || temp->verification!=i )
+            dataLostCnt++;
+        temp = searchFrozenTree( snapshotFrozen, &missing );
+        if( temp==NULL || temp->verification!=i )
+            dataLostCnt++;
+    }
+    createName( 1, testData );
+    initData( &missing, -1, testData );
+    if( searchFrozenTree( ft, &missing )!=NULL || searchFrozenTree( snapshotFrozen, &missing )!=NULL )
+        dataLostCnt++;
+    dataLostCnt += countLongFrozenKeyErrors( );
+
+    if( ft->size!=numKeys || dataLostCnt!=0 )
+        printf( "FAILURE - # frozen tree lookups that disagree with the AVL tree = %d\n", dataLostCnt );
+    else
+        printf( "Frozen tree found all %d keys\n", numKeys );
+
+    freeFrozenTree( ft );
+    freeFrozenTree( snapshotFrozen );
+    closeTreeSnapshot( ts );
+    remove( SNAPSHOT_TEST_FILE );
+    freeTree( pt );
+    printf("\n");
+}
+
+/* countLongFrozenKeyErrors
+ * input: none
+ * output: the number of wrong lookups in a frozen tree of long keys
+ *
+ * The keys (see createLongName) start with FROZEN_KEY_BYTES-2 to FROZEN_KEY_BYTES+1 'x's, so most of them tie on
+ * the inline bytes and are told apart by the rest of the key.  Keys of exactly FROZEN_KEY_BYTES-1 and
+ * FROZEN_KEY_BYTES 'x's check the boundary.
+ */
+int countLongFrozenKeyErrors( ){
+    int i, numKeys = 66, errors = 0;
+    char probe[FROZEN_KEY_BYTES+32];
+    Data *temp, query;
+    Tree* lt = createTree();
+    FrozenTree* ft;
+    lt->type = AVL;
+
+    for( i=0; i<numKeys; i++ ){
+        temp = createData( i, (char*)malloc( (FROZEN_KEY_BYTES+32)*sizeof(char) ) );
+        createLongName( i, temp->key );
+        insertTreeBalanced( lt, temp );
+    }
+
+    ft = freezeTree( lt );
+    for( i=0; i<numKeys; i++ ){
+        createLongName( i, probe );
+        initData( &query, -1, probe );
+        temp = searchFrozenTree( ft, &query );
+        if( temp==NULL || temp->verification!=i )
+            errors++;
+    }
+    memset( probe, 'x', FROZEN_KEY_BYTES );
+    strcpy( probe + FROZEN_KEY_BYTES, "~" );
+    initData( &query, -1, probe );
+    if( ft->size!=numKeys || searchFrozenTree( ft, &query )!=NULL )
+        errors++;
+
+    freeFrozenTree( ft );
+    freeTree( lt );
+    return errors;
+}
+
+/* createLongName
+ * input: an index in 0..65, an array of at least FROZEN_KEY_BYTES+32 chars
+ * output: none
+ *
+ * Index i<64 gives FROZEN_KEY_BYTES-2+i%4 'x's followed by the createName key of i, 64 and 65 give
+ * FROZEN_KEY_BYTES-1 and FROZEN_KEY_BYTES 'x's alone
+ */
+void createLongName( int i, char* keyName ){
+    int length = i<64 ? FROZEN_KEY_BYTES-2+i%4 : FROZEN_KEY_BYTES-65+i;
+
+    memset( keyName, 'x', length );
+    if( i<64 )
+        createName( i, keyName+length );
+    else
+        keyName[length] = '\0';
+}
+
+/* createBenchData
+ * input: the number of keys
+ * output: an array of numKeys Data* with distinct keys in a random order (this is malloc-ed so must be freed eventually!)
+ */
+Data** createBenchData( int numKeys ){
+    int i, j;
+    Data **allData = (Data **)malloc( numKeys*sizeof(Data*) );
+    Data *temp;
+
+    for( i=0; i<numKeys; i++ ){
+        temp = createData( i+2, (char*)malloc( 31*sizeof(char) ) );
+        createName( i+2, temp->key );
+        allData[i] = temp;
+    }
+
+    /* Fisher-Yates shuffle with a fixed seed so runs are reproducible */
+    srand( 2124 );
+    for( i=numKeys-1; i>0; i-- ){
+        j = rand() % (i+1);
+        temp = allData[i];
+        allData[i] = allData[j];
+        allData[j] = temp;
+    }
+    return allData;
+}
+
+/* benchFrozenTree
+ * input: the number of keys to insert, the number of lookups to time
+ * output: none
+ *
+ * Compares random lookup latency of the pointer based AVL tree against the frozen Eytzinger array and the hash index
+ */
+void benchFrozenTree( int numKeys, int numLookups ){
+    int i, found = 0;
+    Data **allData = createBenchData( numKeys );
+    int *order = (int *)malloc( numLookups*sizeof(int) );
+    double start, end;
+    double avlTime, frozenTime, hashTime;
+    Tree* pt = createTree();
+    FrozenTree* ft;
+    pt->type = AVL;
+
+    for( i=0; i<numKeys; i++ )
+        insertTreeBalanced( pt, allData[i] );
+    for( i=0; i<numLookups; i++ )
+        order[i] = rand() % numKeys;
+
+    start = benchSeconds( );
+    ft = freezeTree( pt );
+    end = benchSeconds( );
+    printf( "Time to freeze %d keys (in seconds): %lf\n", numKeys, (end - start) );
+
+    start = benchSeconds( );
+    for( i=0; i<numLookups; i++ )
+        found += searchTree( pt, allData[order[i]] )!=NULL;
+    end = benchSeconds( );
+    avlTime = (end - start);
+
+    start = benchSeconds( );
+    for( i=0; i<numLookups; i++ )
+        found += searchFrozenTree( ft, allData[order[i]] )!=NULL;
+    end = benchSeconds( );
+    frozenTime = (end - start);
+
+    enableHashIndex( pt );
+    start = benchSeconds( );
+    for( i=0; i<numLookups; i++ )
+        found += searchTree( pt, allData[order[i]] )!=NULL;
+    end = benchSeconds( );
+    hashTime = (end - start);
+
+    if( found!=3*numLookups )
+        printf( "FAILURE - # lookups that missed = %d\n", 3*numLookups-found );
+    printf( "AVL tree lookup latency (in ns): %.1lf\n", 1e9*avlTime/numLookups );
+    printf( "Frozen tree lookup latency (in ns): %.1lf\n", 1e9*frozenTime/numLookups );
+    printf( "AVL tree + hash index lookup latency (in ns): %.1lf\n", 1e9*hashTime/numLookups );
+    printf( "Speedup (frozen / hash index): %.2lfx / %.2lfx\n\n", avlTime/frozenTime, avlTime/hashTime );
+
+    freeFrozenTree( ft );
+    freeTree( pt ); /* also frees allData[i] */
+    free( allData );
+    free( order );
+}
+
+
+/**********  Functions for testing/benchmarking tree snapshots **********/
+
+/* checkTreeSnapshot
+ * input: a pointer to an AVL, SEGMENT or HUFFMAN Tree
+ * output: none
+ *
+ * Writes t to a snapshot and loads it back.  Only prints (a FAILURE) if the loaded tree differs, so the output of
+ * the tests is unchanged.  A reloaded AVL tree has its own (perfectly balanced) shape, so only its keys in order
+ * are compared.
+ */
+void checkTreeSnapshot( Tree* t ){
+    TreeSnapshot* ts;
+    Tree* loaded;
+    int errors;
+
+    writeTreeSnapshot( SNAPSHOT_TEST_FILE, t );
+    ts = openTreeSnapshot( SNAPSHOT_TEST_FILE );
+    loaded = loadTreeSnapshot( ts );
+    closeTreeSnapshot( ts );
+    remove( SNAPSHOT_TEST_FILE );
+
+    if( t->type==AVL || t->type==SPLAY )
+        errors = countKeyDifferences( t->root, loaded->root ) + countAVLTreeErrors( loaded->root );
+    else
+        errors = countTNodeDifferences( t->root, loaded->root, t->type );
+    if( loaded->type!=t->type || errors!=0 )
+        printf( "FAILURE - # differences in the tree loaded from a snapshot = %d\n", errors );
+    freeTree( loaded );
+}
+
+/* countTNodeDifferences
+ * input: the roots of two trees, their type
+ * output: the number of TNodes that differ in shape or in the fields of the type
+ */
+int countTNodeDifferences( TNode* a, TNode* b, treeType type ){
+    int cnt = 0;
+
+    if( a==NULL || b==NULL )
+        return a!=b;
+    if( type==SEGMENT && (a->low!=b->low || a->high!=b->high || a->cnt!=b->cnt) )
+        cnt++;
+    if( type==HUFFMAN && (a->priority!=b->priority || (a->str==NULL)!=(b->str==NULL) || (a->str!=NULL && strcmp( a->str, b->str )!=0)) )
+        cnt++;
+    if( a->height!=b->height || (b->pLeft!=NULL && b->pLeft->pParent!=b) || (b->pRight!=NULL && b->pRight->pParent!=b) )
+        cnt++;
+    return cnt + countTNodeDifferences( a->pLeft, b->pLeft, type ) + countTNodeDifferences( a->pRight, b->pRight, type );
+}
+
+/* countKeyDifferences
+ * input: the roots of two AVL trees
+ * output: the number of positions at which the in order keys (or their verification) differ
+ */
+int countKeyDifferences( TNode* a, TNode* b ){
+    TreeIterator itA, itB;
+    TNode *x, *y;
+    int cnt = 0;
+
+    initTreeIterator( &itA, a );
+    initTreeIterator( &itB, b );
+    do{
+        x = nextTreeIterator( &itA );
+        y = nextTreeIterator( &itB );
+        if( (x==NULL)!=(y==NULL) || (x!=NULL && (strcmp( x->data->key, y->data->key )!=0 || x->data->verification!=y->data->verification)) )
+            cnt++;
+    } while( x!=NULL && y!=NULL );
+    return cnt;
+}
+
+/* benchTreeSnapshot
+ * input: the number of keys for the AVL tree, the number of random moves for the segment tree
+ * output: none
+ *
+ * Compares building an AVL tree with insertTreeBalanced (and a filled segment tree from its moves) against
+ * reloading it from a snapshot, both as a Tree and (for the AVL tree) frozen straight from the mapping
+ */
+void benchTreeSnapshot( int numKeys, int numMoves ){
+    Data **allData = createBenchData( numKeys );
+    double* moveSequence = generateMoves( numMoves );
+    double start, buildTime, writeTime, loadTime, freezeTime;
+    Tree *pt = createTree(), *loaded;
+    TreeSnapshot* ts;
+    FrozenTree* ft;
+    long fileSize;
+    int i, errors = 0;
+    MoveSegments ms;
+    pt->type = AVL;
+
+    start = benchSeconds( );
+    for( i=0; i<numKeys; i++ )
+        insertTreeBalanced( pt, allData[i] );
+    buildTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    writeTreeSnapshot( BENCH_SNAPSHOT_FILE, pt );
+    writeTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    ts = openTreeSnapshot( BENCH_SNAPSHOT_FILE );
+    loaded = loadTreeSnapshot( ts );
+    closeTreeSnapshot( ts );
+    loadTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    ts = openTreeSnapshot( BENCH_SNAPSHOT_FILE );
+    ft = freezeTreeSnapshot( ts );
+    freezeTime = benchSeconds( ) - start;
+    fileSize = (long)ts->mappingSize;
+
+    for( i=0; i<numKeys; i++ ){
+        if( searchTree( loaded, allData[i] )==NULL || searchTree( loaded, allData[i] )->data->verification!=allData[i]->verification )
+            errors++;
+        if( searchFrozenTree( ft, allData[i] )==NULL || searchFrozenTree( ft, allData[i] )->verification!=allData[i]->verification )
+            errors++;
+    }
+    errors += countAVLTreeErrors( loaded->root );
+
+    printf( "AVL tree of %d keys, snapshot size (in bytes): %ld\n", numKeys, fileSize );
+    printf( "Build with insertTreeBalanced (in seconds): %lf\n", buildTime );
+    printf( "Write snapshot (in seconds): %lf\n", writeTime );
+    printf( "Load snapshot as an AVL tree (in seconds): %lf\n", loadTime );
+    printf( "Load snapshot as a frozen tree (in seconds): %lf\n", freezeTime );
+    printf( "Speedup over rebuilding (AVL / frozen): %.2lfx / %.2lfx\n", buildTime/loadTime, buildTime/freezeTime );
+
+    freeFrozenTree( ft );
+    closeTreeSnapshot( ts );
+    freeTree( loaded );
+    freeTree( pt ); /* also frees allData[i] */
+    free( allData );
+
+    /* a segment tree filled with every move */
+    start = benchSeconds( );
+    createMoveSegments( moveSequence, numMoves, &ms );
+    pt = createTreeFromTNode( constructSegmentTree( ms.points, 0, ms.numUnique-1 ) );
+    pt->type = SEGMENT;
+    for( i=0; i<numMoves; i++ )
+        insertSegment( pt->root, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+    buildTime = benchSeconds( ) - start;
+
+    writeTreeSnapshot( BENCH_SNAPSHOT_FILE, pt );
+    start = benchSeconds( );
+    ts = openTreeSnapshot( BENCH_SNAPSHOT_FILE );
+    loaded = loadTreeSnapshot( ts );
+    closeTreeSnapshot( ts );
+    loadTime = benchSeconds( ) - start;
+
+    errors += countTNodeDifferences( pt->root, loaded->root, SEGMENT );
+    printf( "Segment tree of %d moves, build and fill (in seconds): %lf\n", numMoves, buildTime );
+    printf( "Load snapshot as a segment tree (in seconds): %lf\n", loadTime );
+    printf( "Speedup over rebuilding: %.2lfx\n", buildTime/loadTime );
+    if( errors!=0 )
+        printf( "FAILURE - # differences between the trees and their snapshots = %d\n", errors );
+    printf( "\n" );
+
+    freeTree( loaded );
+    freeTree( pt );
+    free( moveSequence );
+    freeMoveSegments( &ms );
+    remove( BENCH_SNAPSHOT_FILE );
+}
+
+
+/**********  Functions for testing/benchmarking interned keys **********/
+
+/* testKeyInterning
+ * input: none
+ * output: none
+ *
+ * Interns the keys of two AVL trees (one with a hash index) and of a tree loaded from a snapshot of the first
+ * one into a single KeyTable, then checks every copy of a key is the same pointer and can be found.  Only
+ * prints on FAILURE.
+ */
+void testKeyInterning( ){
+    int i, j, errors = 0;
+    char key[31], *interned;
+    Data *temp, probe;
+    TNode* found;
+    KeyTable* kt = createKeyTable( );
+    Tree *trees[3];
+    TreeSnapshot* ts;
+
+    for( i=0; i<2; i++ ){
+        trees[i] = createTree( );
+        trees[i]->type = AVL;
+    }
+    enableHashIndex( trees[1] );
+    for( i=1; i<=INTERN_TEST_KEYS; i++ ){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        createName( i, temp->key );
+        internData( kt, temp );
+        insertTreeBalanced( trees[0], temp );
+
+        /* the second tree interns a stack copy of the key, which must give the same pointer */
+        createName( i, key );
+        temp = createData( i, internKey( kt, key ) );
+        temp->internedKey = true;
+        insertTreeBalanced( trees[1], temp );
+    }
+    writeTreeSnapshot( SNAPSHOT_TEST_FILE, trees[0] );
+    ts = openTreeSnapshot( SNAPSHOT_TEST_FILE );
+    ts->keys = kt;
+    trees[2] = loadTreeSnapshot( ts );
+    closeTreeSnapshot( ts );
+    remove( SNAPSHOT_TEST_FILE );
+
+    if( kt->size!=INTERN_TEST_KEYS )
+        errors++;
+    for( i=1; i<=INTERN_TEST_KEYS; i++ ){
+        createName( i, key );
+        interned = findInternedKey( kt, key );
+        if( interned==NULL || strcmp( interned, key )!=0 || internKey( kt, key )!=interned ){
+            errors++;
+            continue;
+        }
+        initData( &probe, -1, interned );
+        probe.internedKey = true;
+        if( dataKeyLength( &probe )!=30 || dataKeyHash( &probe )!=keyHash( key ) )
+            errors++;
+        for( j=0; j<3; j++ ){
+            found = searchTree( trees[j], &probe );
+            if( found==NULL || found->data->key!=interned || found->data->verification!=i )
+                errors++;
+        }
+    }
+    createName( INTERN_TEST_KEYS+1, key );
+    if( findInternedKey( kt, key )!=NULL )
+        errors++;
+
+    if( errors!=0 )
+        printf( "FAILURE - # errors in the interned keys = %d\n", errors );
+    for( i=0; i<3; i++ )
+        freeTree( trees[i] ); /* freeData leaves the interned keys to the KeyTable */
+    freeKeyTable( kt );
+}
+
+/* benchKeyInterning
+ * input: the number of keys per tree, the number of lookups to time
+ * output: none
+ *
+ * Fills BENCH_INTERN_TREES AVL trees with the same createName keys, once with a malloc-ed key per Data and
+ * once with the keys interned in a KeyTable, then compares their memory and the lookup latency of probe
+ * keys that arrive as separate strings (with and without a hash index)
+ */
+void benchKeyInterning( int numKeys, int numLookups ){
+    Tree *plainTrees[BENCH_INTERN_TREES], *internedTrees[BENCH_INTERN_TREES];
+    KeyTable* kt = createKeyTable( );
+    Data** allData;
+    Data* probes = (Data*)malloc( numLookups*sizeof(Data) );
+    char** internedProbes = (char**)malloc( numLookups*sizeof(char*) );
+    MemoryUsage plainMemory, internedMemory, mu;
+    double start, plainTimes[2], internedTimes[2], internTime;
+    int i, j, k, found = 0;
+
+    resetMemoryUsage( &plainMemory );
+    resetMemoryUsage( &internedMemory );
+    for( j=0; j<BENCH_INTERN_TREES; j++ ){
+        plainTrees[j] = createTree( );
+        internedTrees[j] = createTree( );
+        plainTrees[j]->type = internedTrees[j]->type = AVL;
+
+        allData = createBenchData( numKeys );
+        for( i=0; i<numKeys; i++ )
+            insertTreeBalanced( plainTrees[j], allData[i] );
+        free( allData );
+        allData = createBenchData( numKeys );
+        for( i=0; i<numKeys; i++ ){
+            internData( kt, allData[i] );
+            insertTreeBalanced( internedTrees[j], allData[i] );
+        }
+        free( allData );
+
+        mu = memoryUsageTree( plainTrees[j] );
+        addMemoryUsage( &plainMemory, &mu );
+        mu = memoryUsageTree( internedTrees[j] );
+        addMemoryUsage( &internedMemory, &mu );
+    }
+    mu = memoryUsageKeyTable( kt );
+    addMemoryUsage( &internedMemory, &mu );
+
+    /* probes are fresh strings, as if they came from a request */
+    for( i=0; i<numLookups; i++ ){
+        initData( &probes[i], -1, (char*)malloc( 31*sizeof(char) ) );
+        createName( rand() % numKeys + 2, probes[i].key );
+    }
+    start = benchSeconds( );
+    for( i=0; i<numLookups; i++ )
+        internedProbes[i] = findInternedKey( kt, probes[i].key );
+    internTime = benchSeconds( ) - start;
+
+    for( k=0; k<2; k++ ){
+        if( k==1 ){
+            enableHashIndex( plainTrees[0] );
+            enableHashIndex( internedTrees[0] );
+        }
+        start = benchSeconds( );
+        for( i=0; i<numLookups; i++ )
+            found += searchTree( plainTrees[0], &probes[i] )!=NULL;
+        plainTimes[k] = benchSeconds( ) - start;
+
+        start = benchSeconds( );
+        for( i=0; i<numLookups; i++ ){
+            Data probe = { .key = internedProbes[i], .internedKey = true };
+            found += searchTree( internedTrees[0], &probe )!=NULL;
+        }
+        internedTimes[k] = benchSeconds( ) - start;
+    }
+
+    if( found!=4*numLookups )
+        printf( "FAILURE - # lookups that missed = %d\n", 4*numLookups-found );
+    printf( "%d trees of %d keys, %d distinct keys interned\n", BENCH_INTERN_TREES, numKeys, kt->size );
+    printf( "Memory with a malloc-ed key per Data (bytes/key): %.1lf\n", (double)totalMemoryUsage( &plainMemory )/plainMemory.numElements );
+    printf( "Memory with interned keys (bytes/key): %.1lf\n", (double)totalMemoryUsage( &internedMemory )/plainMemory.numElements );
+    printf( "Memory saved: %.1lf%%\n", 100.0 - 100.0*totalMemoryUsage( &internedMemory )/totalMemoryUsage( &plainMemory ) );
+    printf( "Interning a probe key (in ns): %.1lf\n", 1e9*internTime/numLookups );
+    printf( "AVL tree lookup latency, malloc-ed / interned keys (in ns): %.1lf / %.1lf\n", 1e9*plainTimes[0]/numLookups, 1e9*internedTimes[0]/numLookups );
+    printf( "AVL tree + hash index lookup latency, malloc-ed / interned keys (in ns): %.1lf / %.1lf\n\n", 1e9*plainTimes[1]/numLookups, 1e9*internedTimes[1]/numLookups );
+
+    for( j=0; j<BENCH_INTERN_TREES; j++ ){
+        freeTree( plainTrees[j] );
+        freeTree( internedTrees[j] );
+    }
+    freeKeyTable( kt );
+    for( i=0; i<numLookups; i++ )
+        free( probes[i].key );
+    free( probes );
+    free( internedProbes );
+}
+
+
+/**********  Functions for testing/benchmarking sharded maps **********/
+
+/* testShardedMap
+ * input: none
+ * output: none
+ *
+ * Stores the testAVLTree keys in a 4-shard map and checks search, duplicate inserts, the ordered scan across
+ * the shards and removal.  Only prints on FAILURE.
+ */
+void testShardedMap( ){
+    int i, numKeys = 0, numScanned = 0, errors = 0;
+    char** sampleKeys;
+    Data *temp, query;
+    TNode *x, *prev = NULL;
+    ShardedMapIterator it;
+    ShardedMap* sm;
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1)
+        numKeys++;
+    sampleKeys = (char**)malloc( numKeys*sizeof(char*) );
+    numKeys = 0;
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        sampleKeys[numKeys] = (char*)malloc( 31*sizeof(char) );
+        createName( i, sampleKeys[numKeys++] );
+    }
+    sm = createShardedMapFromSample( SHARD_TEST_SHARDS, sampleKeys, numKeys );
+    for( i=0; i<numKeys; i++ ){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        strcpy( temp->key, sampleKeys[i] );
+        if( !insertShardedMap( sm, temp ) )
+            errors++;
+    }
+
+    /* a second copy of every key must be turned away */
+    for( i=0; i<numKeys; i++ ){
+        initData( &query, -1, sampleKeys[i] );
+        temp = searchShardedMap( sm, &query );
+        if( temp==NULL || temp->verification!=i || insertShardedMap( sm, &query ) )
+            errors++;
+    }
+
+    initShardedMapIterator( &it, sm );
+    while( (x = nextShardedMapIterator( &it ))!=NULL ){
+        if( prev!=NULL && strcmp( prev->data->key, x->data->key )>=0 )
+            errors++;
+        if( findShard( sm, x->data->key )!=it.shard )
+            errors++;
+        prev = x;
+        numScanned++;
+    }
+    if( numScanned!=numKeys || memoryUsageShardedMap( sm ).numElements!=numKeys )
+        errors++;
+
+    /* remove every other key */
+    for( i=0; i<numKeys; i+=2 ){
+        temp = removeShardedMap( sm, sampleKeys[i] );
+        if( temp==NULL || temp->verification!=i )
+            errors++;
+        else
+            freeData( temp );
+    }
+    for( i=0; i<numKeys; i++ ){
+        initData( &query, -1, sampleKeys[i] );
+        if( (searchShardedMap( sm, &query )!=NULL) != (i%2==1) )
+            errors++;
+    }
+    for( i=0; i<sm->numShards; i++ )
+        errors += countAVLTreeErrors( sm->shards[i].tree->root );
+
+    if( errors!=0 )
+        printf( "FAILURE - # errors in the sharded map = %d\n", errors );
+    freeShardedMap( sm );
+    for( i=0; i<numKeys; i++ )
+        free( sampleKeys[i] );
+    free( sampleKeys );
+}
+
+/* shardInsertTask
+ * input: a pointer to a ShardBenchTask
+ * output: NULL
+ *
+ * Walks the Collatz sequences of numWalks random starts (from the task's own seed) and inserts every value
+ * until it reaches one that is already stored, as testAVLTree and benchBTree do
+ */
+void* shardInsertTask( void* arg ){
+    ShardBenchTask* task = (ShardBenchTask*)arg;
+    uint64_t state = task->seed;
+    char testData[31];
+    Data* temp;
+    long v;
+    int w;
+
+    for( w=0; w<task->numWalks; w++ ){
+        for( v = 2 + nextRandom( &state ) % (task->numStarts-1); v!=1; v = v%2==0 ? v/2 : v*3+1 ){
+            createName( v, testData );
+            temp = createData( task->numInserted, (char*)malloc( 31*sizeof(char) ) );
+            strcpy( temp->key, testData );
+            if( !insertShardedMap( task->map, temp ) ){
+                freeData( temp );
+                break;
+            }
+            if( task->numInserted==task->capacity ){
+                task->capacity *= 2;
+                task->inserted = (Data **)realloc( task->inserted, task->capacity*sizeof(Data*) );
+            }
+            task->inserted[task->numInserted++] = temp;
+        }
+    }
+    if( STATS_ENABLED )
+        flushStats( ); /* this may be a worker thread */
+    return NULL;
+}
+
+/* shardRemoveTask
+ * input: a pointer to a ShardBenchTask
+ * output: NULL
+ *
+ * Removes the keys this task inserted in a random order (from the task's own seed) and frees their Data
+ */
+void* shardRemoveTask( void* arg ){
+    ShardBenchTask* task = (ShardBenchTask*)arg;
+    uint64_t state = ~task->seed;
+    Data* temp;
+    int i, j;
+
+    for( i=task->numInserted-1; i>0; i-- ){
+        j = nextRandom( &state ) % (i+1);
+        temp = task->inserted[i];
+        task->inserted[i] = task->inserted[j];
+        task->inserted[j] = temp;
+    }
+    for( i=0; i<task->numInserted; i++ ){
+        if( removeShardedMap( task->map, task->inserted[i]->key )!=task->inserted[i] )
+            task->errors++;
+        freeData( task->inserted[i] );
+    }
+    if( STATS_ENABLED )
+        flushStats( ); /* this may be a worker thread */
+    return NULL;
+}
+
+/* benchShardedMap
+ * input: the Collatz sequences of random starts in 2..numStarts are inserted
+ * output: none
+ *
+ * Times the multithreaded insert and remove phases with 1 shard (one lock, so every writer serializes) and
+ * with BENCH_SHARDS shards for 1, 2, 4, ... threads.  Thread t draws its starts from the seed
+ * BENCH_SHARD_SEED+t.  Between the phases the map is checked with an ordered scan (not timed).
+ */
+void benchShardedMap( int numStarts ){
+    int numCores = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    int shardCounts[] = { 1, BENCH_SHARDS };
+    int numSamples = 0, numKeys, numScanned, errors, c, i, t, numThreads;
+    char** sampleKeys = (char**)malloc( BENCH_SHARD_SAMPLES*sizeof(char*) );
+    uint64_t state = BENCH_SHARD_SEED-1;
+    long v;
+    ShardBenchTask* tasks;
+    pthread_t* threads;
+    bool* started;
+    ShardedMap* sm;
+    ShardedMapIterator it;
+    TNode *x, *prev;
+    double start, insertTime, removeTime;
+
+    /* the split keys come from the same kind of walks with a seed no thread uses */
+    while( numSamples<BENCH_SHARD_SAMPLES ){
+        for( v = 2 + nextRandom( &state ) % (numStarts-1); v!=1 && numSamples<BENCH_SHARD_SAMPLES; v = v%2==0 ? v/2 : v*3+1 ){
+            sampleKeys[numSamples] = (char*)malloc( 31*sizeof(char) );
+            createName( v, sampleKeys[numSamples++] );
+        }
+    }
+
+    printf( "Collatz starts: 2..%d, online cores: %d\n", numStarts, numCores );
+    for( c=0; c<2; c++ ){
+        for( numThreads=1; numThreads<=numCores || numThreads<=2; numThreads*=2 ){
+            sm = createShardedMapFromSample( shardCounts[c], sampleKeys, numSamples );
+            tasks = (ShardBenchTask*)malloc( numThreads*sizeof(ShardBenchTask) );
+            threads = (pthread_t*)malloc( numThreads*sizeof(pthread_t) );
+            started = (bool*)malloc( numThreads*sizeof(bool) );
+            for( t=0; t<numThreads; t++ ){
+                tasks[t].map = sm;
+                tasks[t].numStarts = numStarts;
+                tasks[t].numWalks = (numStarts-1)/numThreads;
+                tasks[t].seed = BENCH_SHARD_SEED + t;
+                tasks[t].capacity = 1024;
+                tasks[t].inserted = (Data **)malloc( tasks[t].capacity*sizeof(Data*) );
+                tasks[t].numInserted = 0;
+                tasks[t].errors = 0;
+            }
+
+            start = benchSeconds( );
+            for( t=1; t<numThreads; t++ ){
+                started[t] = pthread_create( &threads[t], NULL, shardInsertTask, &tasks[t] )==0;
+                if( !started[t] )
+                    shardInsertTask( &tasks[t] ); /* run here if no thread can be started */
+            }
+            shardInsertTask( &tasks[0] );
+            for( t=1; t<numThreads; t++ )
+                if( started[t] )
+                    pthread_join( threads[t], NULL );
+            insertTime = benchSeconds( ) - start;
+
+            numKeys = errors = numScanned = 0;
+            for( t=0; t<numThreads; t++ )
+                numKeys += tasks[t].numInserted;
+            prev = NULL;
+            initShardedMapIterator( &it, sm );
+            while( (x = nextShardedMapIterator( &it ))!=NULL ){
+                if( prev!=NULL && strcmp( prev->data->key, x->data->key )>=0 )
+                    errors++;
+                prev = x;
+                numScanned++;
+            }
+            for( i=0; i<sm->numShards; i++ )
+                errors += countAVLTreeErrors( sm->shards[i].tree->root );
+            if( numScanned!=numKeys )
+                errors++;
+
+            start = benchSeconds( );
+            for( t=1; t<numThreads; t++ ){
+                started[t] = pthread_create( &threads[t], NULL, shardRemoveTask, &tasks[t] )==0;
+                if( !started[t] )
+                    shardRemoveTask( &tasks[t] ); /* run here if no thread can be started */
+            }
+            shardRemoveTask( &tasks[0] );
+            for( t=1; t<numThreads; t++ )
+                if( started[t] )
+                    pthread_join( threads[t], NULL );
+            removeTime = benchSeconds( ) - start;
+
+            for( t=0; t<numThreads; t++ ){
+                errors += tasks[t].errors;
+                free( tasks[t].inserted );
+            }
+            for( i=0; i<sm->numShards; i++ )
+                errors += sm->shards[i].tree->root!=NULL;
+            if( errors!=0 )
+                printf( "FAILURE - # errors in the sharded map = %d\n", errors );
+            printf( "Shards: %2d, threads: %2d, keys: %d, insert (in seconds): %lf, remove (in seconds): %lf, %.2lf Mops/s\n",
+                    sm->numShards, numThreads, numKeys, insertTime, removeTime, 2e-6*numKeys/(insertTime + removeTime) );
+
+            freeShardedMap( sm );
+            free( tasks );
+            free( threads );
+            free( started );
+        }
+    }
+    printf( "\n" );
+
+    for( i=0; i<numSamples; i++ )
+        free( sampleKeys[i] );
+    free( sampleKeys );
+}
+
+
+/**********  Functions for testing/benchmarking splay trees **********/
+
+/* testSplayTree
+ * input: none
+ * output: none
+ *
+ * Stores the testAVLTree keys in a SPLAY tree and checks that every key inserted or found ends up at the
+ * root, that the keys stay in order and that removing every other key leaves the rest.  Only prints on FAILURE.
+ */
+void testSplayTree( ){
+    int i, j, numKeys = 0, numScanned = 0, errors = 0;
+    char testData[31];
+    Data *temp, query;
+    TNode *x, *prev = NULL;
+    TreeIterator it;
+    Tree* pt = createTree( );
+    pt->type = SPLAY;
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        createName( i, temp->key );
+        insertTree( pt, temp );
+        if( pt->root->data!=temp )
+            errors++;
+        numKeys++;
+    }
+
+    /* a second copy of a key is not stored, its TNode is splayed instead */
+    createName( MAX_VALUE, testData );
+    initData( &query, -1, testData );
+    insertTreeBalanced( pt, &query );
+    if( pt->root->data->verification!=MAX_VALUE )
+        errors++;
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        createName( i, testData );
+        x = searchTree( pt, &query );
+        if( x==NULL || x!=pt->root || x->data->verification!=i )
+            errors++;
+    }
+    createName( 1, testData );
+    if( searchTree( pt, &query )!=NULL || pt->root==NULL )
+        errors++;
+
+    initTreeIterator( &it, pt->root );
+    while( (x = nextTreeIterator( &it ))!=NULL ){
+        if( prev!=NULL && compareData( prev->data, x->data )>=0 )
+            errors++;
+        if( x->pLeft!=NULL && x->pLeft->pParent!=x )
+            errors++;
+        if( x->pRight!=NULL && x->pRight->pParent!=x )
+            errors++;
+        prev = x;
+        numScanned++;
+    }
+    if( numScanned!=numKeys || memoryUsageTree( pt ).numElements!=numKeys )
+        errors++;
+    checkTreeSnapshot( pt );
+
+    /* remove every other key, then check which keys are left */
+    for( i=MAX_VALUE, j=0; i!=1; i= i%2==0 ? i/2 : i*3+1, j++){
+        if( j%2==1 )
+            continue;
+        createName( i, testData );
+        temp = removeTree( pt, testData );
+        if( temp==NULL || temp->verification!=i )
+            errors++;
+        else
+            freeData( temp );
+    }
+    for( i=MAX_VALUE, j=0; i!=1; i= i%2==0 ? i/2 : i*3+1, j++){
+        createName( i, testData );
+        if( (searchTree( pt, &query )!=NULL) != (j%2==1) )
+            errors++;
+    }
+    strcpy( testData, pt->root->data->key );
+    temp = removeTree( pt, testData );
+    if( temp==NULL || removeTree( pt, testData )!=NULL )
+        errors++;
+    else
+        freeData( temp );
+
+    if( errors!=0 )
+        printf( "FAILURE - # errors in the splay tree = %d\n", errors );
+    freeTree( pt );
+}
+
+/* benchSplayTree
+ * input: the number of keys, the number of lookups in each stream
+ * output: none
+ *
+ * Replays the same lookup streams, uniform and then Zipfian with growing exponents (the popular keys are
+ * spread over the key space), against an AVL tree and a SPLAY tree holding the same keys.  Next to the time
+ * per lookup it prints the average depth of the keys looked up (probed after the timed pass, so the SPLAY tree
+ * keeps adapting) and the entropy of the stream, the order of the best average depth any BST can reach.
+ */
+void benchSplayTree( int numKeys, int numLookups ){
+    double exponents[BENCH_SPLAY_STREAMS] = { 0, 0.8, WORKLOAD_ZIPF_EXPONENT, 1.2 };
+    Data **avlData = createBenchData( numKeys );
+    Data **splayData = createBenchData( numKeys );
+    char (*lookupKeys)[31] = malloc( numLookups*sizeof( *lookupKeys ) );
+    int* counts = (int*)malloc( numKeys*sizeof(int) );
+    int* popularity = (int*)malloc( numKeys*sizeof(int) );
+    uint64_t state = BENCH_SPLAY_SEED;
+    Tree *trees[2] = { createTree( ), createTree( ) };
+    ZipfGenerator* zipf;
+    Data query;
+    double start, entropy, p, times[2];
+    long depths[2];
+    int i, j, e, k, rank, found, errors = 0;
+
+    trees[0]->type = AVL;
+    trees[1]->type = SPLAY;
+    for( i=0; i<numKeys; i++ ){
+        insertTreeBalanced( trees[0], avlData[i] );
+        insertTreeBalanced( trees[1], splayData[i] );
+    }
+    /* Zipf rank r is the key avlData[popularity[r]], so how popular a key is does not depend on when the AVL
+     * tree got it (the first keys inserted end up near its root) */
+    for( i=0; i<numKeys; i++ )
+        popularity[i] = i;
+    for( i=numKeys-1; i>0; i-- ){
+        j = nextRandom( &state ) % (i+1);
+        k = popularity[i];
+        popularity[i] = popularity[j];
+        popularity[j] = k;
+    }
+
+    printf( "Keys: %d, lookups per stream: %d\n", numKeys, numLookups );
+    for( e=0; e<BENCH_SPLAY_STREAMS; e++ ){
+        zipf = createZipfGenerator( numKeys, exponents[e], BENCH_SPLAY_SEED+e );
+        memset( counts, 0, numKeys*sizeof(int) );
+        for( i=0; i<numLookups; i++ ){
+            rank = nextZipf( zipf );
+            counts[rank]++;
+            strcpy( lookupKeys[i], avlData[ popularity[rank] ]->key );
+        }
+        entropy = 0;
+        for( i=0; i<numKeys; i++ ){
+            if( counts[i]==0 )
+                continue;
+            p = (double)counts[i]/numLookups;
+            entropy -= p*log2( p );
+        }
+
+        for( k=0; k<2; k++ ){
+            found = 0;
+            start = benchSeconds( );
+            for( i=0; i<numLookups; i++ ){
+                initData( &query, -1, lookupKeys[i] );
+                found += searchTree( trees[k], &query )!=NULL;
+            }
+            times[k] = benchSeconds( ) - start;
+            errors += found!=numLookups;
+
+            depths[k] = 0;
+            for( i=0; i<numLookups; i++ ){
+                initData( &query, -1, lookupKeys[i] );
+                depths[k] += searchDepth( trees[k], &query );
+                searchTree( trees[k], &query );
+            }
+        }
+        printf( "Zipf exponent %.2lf, entropy %5.2lf bits: AVL %6.1lf ns/lookup (depth %5.2lf), splay %6.1lf ns/lookup (depth %5.2lf), speedup %.2lfx\n",
+                exponents[e], entropy, 1e9*times[0]/numLookups, (double)depths[0]/numLookups,
+                1e9*times[1]/numLookups, (double)depths[1]/numLookups, times[0]/times[1] );
+        freeZipfGenerator( zipf );
+    }
+
+    errors += countAVLTreeErrors( trees[0]->root );
+    for( i=0; i<numKeys; i++ )
+        if( removeTree( trees[1], splayData[i]->key )!=splayData[i] )
+            errors++;
+        else
+            freeData( splayData[i] );
+    errors += trees[1]->root!=NULL;
+    if( errors!=0 )
+        printf( "FAILURE - # errors in the splay tree benchmark = %d\n", errors );
+    printf( "\n" );
+
+    freeTree( trees[0] ); /* also frees avlData[i] */
+    freeTree( trees[1] );
+    free( avlData );
+    free( splayData );
+    free( lookupKeys );
+    free( counts );
+    free( popularity );
+}
+
+/* searchDepth
+ * input: a pointer to a Tree, a Data* tData
+ * output: the number of TNodes a search for tData compares against (without splaying anything)
+ */
+int searchDepth( Tree* t, Data* tData ){
+    TNode* cur = t->root;
+    int cmp, depth = 0;
+
+    while( cur!=NULL ){
+        depth++;
+        cmp = compareData( tData, cur->data );
+        if( cmp==0 )
+            break;
+        cur = cmp<0 ? cur->pLeft : cur->pRight;
+    }
+    return depth;
+}
+
+
+/**********  Functions for testing/benchmarking B-trees **********/
+
+/* countBTreeErrors
+ * input: a BNode, the keys bounding the subtree (NULL for unbounded), the depth of x, the depth of the first leaf found, whether x is the root
+ * output: the number of problems found in the subtree
+ *
+ * Checks key order, the number of keys per node and that all leaves are at the same depth
+ */
+int countBTreeErrors( BNode* x, char* low, char* high, int depth, int* leafDepth, bool isRoot ){
+    int i, cnt = 0;
+    if( x==NULL )
+        return 0;
+    if( x->numKeys > BTREE_MAX_KEYS || (!isRoot && x->numKeys < BTREE_MIN_DEGREE-1) )
+        cnt++;
+    for( i=0; i<x->numKeys; i++ ){
+        if( (i>0 && strcmp( x->keys[i-1], x->keys[i] )>=0) || x->keys[i]!=x->data[i]->key )
+            cnt++;
+        if( (low!=NULL && strcmp( x->keys[i], low )<=0) || (high!=NULL && strcmp( x->keys[i], high )>=0) )
+            cnt++;
+    }
+    if( x->isLeaf ){
+        if( *leafDepth==-1 )
+            *leafDepth = depth;
+        else if( *leafDepth!=depth )
+            cnt++;
+        return cnt;
+    }
+    for( i=0; i<=x->numKeys; i++ )
+        cnt += countBTreeErrors( x->children[i], i==0 ? low : x->keys[i-1], i==x->numKeys ? high : x->keys[i], depth+1, leafDepth, false );
+    return cnt;
+}
+
+/* testBTree
+ * input: none
+ * output: none
+ *
+ * Runs the same inserts and removes as testAVLTree on a BTree
+ */
+void testBTree( ){
+    int i, errorCnt = 0, dataLostCnt = 0, leafDepth;
+    char testData[31];
+    Data *temp;
+    BTree* bt = createBTree();
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        createName( i, temp->key );
+        insertBTree( bt, temp );
+        leafDepth = -1;
+        errorCnt += countBTreeErrors( bt->root, NULL, NULL, 0, &leafDepth, true );
+        if( searchBTree( bt, temp )!=temp )
+            dataLostCnt++;
+    }
+
+    for( i=MAX_VALUE; i!=1; i= i%2==0 ? i/2 : i*3+1){
+        createName( i, testData );
+        temp = removeBTree( bt, testData );
+        if( temp==NULL || temp->verification!=i )
+            dataLostCnt++;
+        if( temp!=NULL )
+            freeData( temp );
+        if( removeBTree( bt, testData )!=NULL )
+            dataLostCnt++;
+        leafDepth = -1;
+        errorCnt += countBTreeErrors( bt->root, NULL, NULL, 0, &leafDepth, true );
+    }
+
+    if( errorCnt!=0 )
+        printf( "FAILURE - # errors in B-tree structure = %d\n", errorCnt );
+    if( dataLostCnt!=0 || bt->size!=0 )
+        printf( "FAILURE - # B-tree elements lost = %d\n", dataLostCnt );
+    if( errorCnt==0 && dataLostCnt==0 && bt->size==0 )
+        printf( "B-tree inserted and removed every key correctly\n" );
+
+    freeBTree( bt );
+    printf("\n");
+}
+
+/* benchBTree
+ * input: the number of Collatz sequences to walk
+ * output: none
+ *
+ * Scaled up version of the testAVLTree workload: walks the Collatz sequence of every start in 2..numStarts and
+ * inserts each value until it reaches one that is already stored (the rest of that sequence is already there).
+ * The same keys are then removed in the same order.  Every Data is made before the clock starts, so the AVL
+ * tree and the B-tree run the identical timed loop: a search per visited value, then an insert if it is new.
+ */
+void benchBTree( int numStarts ){
+    long i;
+    int s, numKeys = 0, numProbes = 0, capacity = 1024, probeCapacity = 1024, k;
+    Data **allData = (Data **)malloc( capacity*sizeof(Data*) );
+    Data **probes = (Data **)malloc( probeCapacity*sizeof(Data*) );
+    Data *temp, query;
+    char testData[31];
+    double start, end;
+    double avlInsert, avlRemove, bInsert, bRemove;
+    Tree* pt = createTree();
+    Tree* seen = createTree();
+    BTree* bt = createBTree();
+    TreeIterator it;
+    TNode* x;
+    pt->type = AVL;
+    seen->type = AVL;
+
+    /* not timed: make the Data of every new value and list the values in the order the walks visit them
+     * (each walk ends on a value that is already stored, which is probed with its stored Data) */
+    initData( &query, -1, testData );
+    for( s=2; s<=numStarts; s++ ){
+        for( i=s; i!=1; i= i%2==0 ? i/2 : i*3+1 ){
+            if( numKeys==capacity ){
+                capacity *= 2;
+                allData = (Data **)realloc( allData, capacity*sizeof(Data*) );
+            }
+            if( numProbes==probeCapacity ){
+                probeCapacity *= 2;
+                probes = (Data **)realloc( probes, probeCapacity*sizeof(Data*) );
+            }
+            createName( i, testData );
+            x = searchTree( seen, &query );
+            if( x!=NULL ){
+                probes[numProbes++] = x->data;
+                break;
+            }
+            temp = createData( numKeys, (char*)malloc( 31*sizeof(char) ) );
+            strcpy( temp->key, testData );
+            insertTreeBalanced( seen, temp );
+            allData[numKeys++] = temp;
+            probes[numProbes++] = temp;
+        }
+    }
+    /* seen only indexed the Data, they belong to pt and bt */
+    initTreeIterator( &it, seen->root );
+    while( (x = nextTreeIterator( &it ))!=NULL )
+        x->data = NULL;
+    freeTree( seen );
+
+    /* AVL: search for the next value and insert it if it is new */
+    start = benchSeconds( );
+    for( k=0; k<numProbes; k++ ){
+        if( searchTree( pt, probes[k] )==NULL )
+            insertTreeBalanced( pt, probes[k] );
+    }
+    end = benchSeconds( );
+    avlInsert = (end - start);
+
+    /* B-tree: the same searches and inserts */
+    start = benchSeconds( );
+    for( k=0; k<numProbes; k++ ){
+        if( searchBTree( bt, probes[k] )==NULL )
+            insertBTree( bt, probes[k] );
+    }
+    end = benchSeconds( );
+    bInsert = (end - start);
+    free( probes );
+
+    if( bt->size!=numKeys )
+        printf( "FAILURE - B-tree holds %d keys instead of %d\n", bt->size, numKeys );
+
+    /* remove every key in insertion order (the trees hand the Data* back, it is freed below) */
+    start = benchSeconds( );
+    for( k=0; k<numKeys; k++ ){
+        if( removeTree( pt, allData[k]->key )!=allData[k] )
+            printf( "FAILURE - AVL tree returned the wrong data for %s\n", allData[k]->key );
+    }
+    end = benchSeconds( );
+    avlRemove = (end - start);
+
+    start = benchSeconds( );
+    for( k=0; k<numKeys; k++ ){
+        if( removeBTree( bt, allData[k]->key )!=allData[k] )
+            printf( "FAILURE - B-tree returned the wrong data for %s\n", allData[k]->key );
+    }
+    end = benchSeconds( );
+    bRemove = (end - start);
+
+    printf( "Collatz keys from %d sequences: %d\n", numStarts-1, numKeys );
+    printf( "AVL tree search+insert / remove time (in seconds): %lf / %lf\n", avlInsert, avlRemove );
+    printf( "B-tree search+insert / remove time (in seconds): %lf / %lf\n", bInsert, bRemove );
+    printf( "Speedup: %.2lfx / %.2lfx\n\n", avlInsert/bInsert, avlRemove/bRemove );
+
+    for( k=0; k<numKeys; k++ )
+        freeData( allData[k] );
+    free( allData );
+    freeTree( pt );
+    freeBTree( bt );
+}
+
+
+/**********  Functions for testing Segment Tree **********/
+
+void testSegmentTree( char *fileName ){
+    double *moveSequence, *scannedSequence;
+    int providedSolution, computedSolution, scannedSolution, solution;
+    int numMoves, numScanned, i;
+
+    readArray( fileName, &moveSequence, &providedSolution, &numMoves );
+
+    /* the bulk loader must read exactly what fscanf reads */
+    readArrayScanf( fileName, &scannedSequence, &scannedSolution, &numScanned );
+    if( numScanned!=numMoves || scannedSolution!=providedSolution || memcmp( scannedSequence, moveSequence, numMoves*sizeof( double ) )!=0 )
+        printf( "FAILURE - the bulk loader read %s differently than fscanf\n", fileName );
+    free( scannedSequence );
+
+    /* every engine runs once, the first one is the reference and the others are checked against its result */
+    computedSolution = carTraversalEngines[0].run( moveSequence, numMoves );
+
+    printf( "Your segment tree computed a solution of %d\n", computedSolution );
+    if( providedSolution!=-1 && computedSolution==providedSolution ){
+        printf( "Your algorithm worked correctly (i.e. same as provided solution)\n" );
+    }
+    else if( providedSolution!=-1){
+        printf( "Your algorithm did not match the provided solution of %d.\n", providedSolution );
+    }
+
+    for( i=1; i<NUM_CAR_TRAVERSAL_ENGINES; i++ ){
+        solution = carTraversalEngines[i].run( moveSequence, numMoves );
+        if( solution!=computedSolution )
+            printf( "FAILURE - the %s computed a solution of %d\n", carTraversalEngines[i].description, solution );
+    }
+    printf("\n");
+
+    free( moveSequence );
+}
+
+/* readArray
+ * input: the name of a move file, pointers for the moves (malloc-ed), the provided solution and the number of moves
+ * output: none
+ *
+ * Reads a text or binary move file with loadMoveFile
+ */
+void readArray( char *fileName, double** pmoveSequence, int* pprovidedSolution, int* pnumMoves ){
+    MoveFile* mf;
+
+    *pmoveSequence = NULL;
+    *pnumMoves = 0;
+    *pprovidedSolution = -1;
+
+    if( fileName != NULL ){
+        mf = loadMoveFile( fileName, 1 );
+        *pnumMoves = mf->numMoves;
+        *pprovidedSolution = mf->providedSolution;
+        if( mf->ownsMoves ){
+            (*pmoveSequence) = mf->moves;
+            mf->ownsMoves = false;
+        }
+        else{
+            /* a binary file was mapped zero-copy, but the callers free the moves */
+            (*pmoveSequence) = (double*) malloc( (*pnumMoves)*sizeof( double ) );
+            memcpy( *pmoveSequence, mf->moves, (*pnumMoves)*sizeof( double ) );
+        }
+        freeMoveFile( mf );
+    }
+}
+
+/* readArrayScanf
+ * input: the same as readArray
+ * output: none
+ *
+ * The original fscanf based reader for text move files, kept to check and time the bulk loader against
+ */
+void readArrayScanf( char *fileName, double** pmoveSequence, int* pprovidedSolution, int* pnumMoves ){
+    double* moveSequence;
+
+    *pmoveSequence = NULL;
+    *pnumMoves = 0;
+    *pprovidedSolution = -1;
+
+    int i;
+
+    if( fileName != NULL ){
+        FILE *in_file = fopen(fileName, "r");
+
+        if(in_file == NULL)
+        {
+            printf("File %s not found.\n", fileName);
+            exit(-1);
+        }
+
+        /* read the number of nodes from file and allocate space to store them */
+        if( fscanf( in_file, "%d%d", pnumMoves, pprovidedSolution ) != 2 )
+        {
+            printf( "Invalid file format.  First line should be number of moves followed by the correct solution (or -1 if none is provided)\n");
+            exit(-1);
+        }
+        if( *pnumMoves < 0 )
+        {
+            printf( "The number moves must be non-negative.\n");
+            exit(-1);
+        }
+
+        (*pmoveSequence) = (double*) malloc( (*pnumMoves)*sizeof( double ) );
+        moveSequence = (*pmoveSequence);
+        /* read in names of nodes */
+        for( i=0 ; i<(*pnumMoves); i++)
+        {
+            if( fscanf( in_file, "%lf", &moveSequence[i] ) == 0 )
+            {
+                printf( "Failed to read %dth double in the move sequence", i );
+                exit(-1);
+            }
+        }
+        fclose( in_file );
+    }
+}
+
+/* buildSegments
+ * input: the move sequence, the number of moves, arrays of numMoves, numMoves and numMoves+1 doubles
+ * output: the number of unique points
+ *
+ * Stores the line segment covered by each move (low end first) and the sorted unique positions of the car
+ */
+int buildSegments( double moveSequence[], int numMoves, double* segmentStartArray, double* segmentEndArray, double* points ){
+    double current = 0, next = 0;
+    int i;
+
+    points[0] = 0;
+    for( i=0 ; i<numMoves; i++)
+    {
+        current = next;
+        next = next + moveSequence[i];
+
+        if( current < next ){
+            segmentStartArray[i] = current;
+            segmentEndArray[i] = next;
+        }
+        else{
+            segmentStartArray[i] = next;
+            segmentEndArray[i] = current;
+        }
+        points[i+1] = next;
+    }
+
+    /* Sort the points and remove all duplicates */
+    return sortUniqueDoubles( points, numMoves+1 );
+}
+
+/* createMoveSegments
+ * input: the move sequence, the number of moves, the MoveSegments to fill
+ * output: none
+ *
+ * Allocates the arrays of ms and fills them with buildSegments
+ */
+void createMoveSegments( double moveSequence[], int numMoves, MoveSegments* ms ){
+    ms->segmentStartArray = (double*) malloc( numMoves*sizeof( double ) );
+    ms->segmentEndArray = (double*) malloc( numMoves*sizeof( double ) );
+    ms->points = (double*) malloc( (numMoves+1)*sizeof( double ) );
+    ms->numUnique = buildSegments( moveSequence, numMoves, ms->segmentStartArray, ms->segmentEndArray, ms->points );
+}
+
+/* freeMoveSegments
+ * input: a MoveSegments filled by createMoveSegments
+ * output: none
+ *
+ * Frees the arrays of ms (but not ms itself)
+ */
+void freeMoveSegments( MoveSegments* ms ){
+    free( ms->segmentStartArray );
+    free( ms->segmentEndArray );
+    free( ms->points );
+}
+
+/* findCarTraversalEngine
+ * input: the name of a car traversal engine
+ * output: its entry in carTraversalEngines (or NULL if there is none)
+ */
+CarTraversalEngine* findCarTraversalEngine( char* name ){
+    int i;
+
+    for( i=0; i<NUM_CAR_TRAVERSAL_ENGINES; i++ ){
+        if( strcmp( carTraversalEngines[i].name, name )==0 )
+            return &carTraversalEngines[i];
+    }
+    return NULL;
+}
+
+int carTraversalTree( double moveSequence[], int numMoves ){
+    int i, max;
+    double* segmentStartArray = (double*) malloc( numMoves*sizeof( double ) );
+    double* segmentEndArray = (double*) malloc( numMoves*sizeof( double ) );
+    double* points = (double*) malloc( (numMoves+1)*sizeof( double ) );
+    Tree* pt;
+    TNode* root;
+
+    int numUnique = buildSegments( moveSequence, numMoves, segmentStartArray, segmentEndArray, points );
+
+    /* build the segment tree */
+    root = constructSegmentTree( points, 0, numUnique-1 );
+    pt = createTreeFromTNode( root );
+    pt->type = SEGMENT;
+
+    if( PRINT_SEGMENT_TREE ){
+        printf("\nSEGMENT TREE - before inserting any line segments:\n" );
+        printTreeByType( pt, pt->root, 0 );
+        printf("\n");
+    }
+    /* insert the line segments */
+    for( i=0 ; i<numMoves; i++){
+        insertSegment( root, segmentStartArray[i], segmentEndArray[i] );
+
+        if( PRINT_SEGMENT_TREE ){
+            printf("SEGMENT TREE - after inserting the line segment (%0.2lf,%0.2lf):\n", segmentStartArray[i], segmentEndArray[i] );
+            printTreeByType( pt, pt->root, 0 );
             printf("\n");
         }
     }
@@ -386,11 +2426,670 @@ int carTraversalTree( double moveSequence[], int numMoves ){
     free( points );
     free( segmentStartArray );
     free( segmentEndArray );
-    free( moveSequence );
 
     return max;
 }
 
+/* carTraversalSnapshot
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Same algorithm as carTraversalTree, but the stabbing queries go to a copy of the filled segment tree that was
+ * written to a snapshot and loaded back
+ */
+int carTraversalSnapshot( double moveSequence[], int numMoves ){
+    int i, temp, max = -1;
+    MoveSegments ms;
+    Tree *pt, *loaded;
+    TreeSnapshot* ts;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+    pt = createTreeFromTNode( constructSegmentTree( ms.points, 0, ms.numUnique-1 ) );
+    pt->type = SEGMENT;
+    for( i=0 ; i<numMoves; i++)
+        insertSegment( pt->root, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+
+    writeTreeSnapshot( SNAPSHOT_TEST_FILE, pt );
+    ts = openTreeSnapshot( SNAPSHOT_TEST_FILE );
+    loaded = loadTreeSnapshot( ts );
+    closeTreeSnapshot( ts );
+    remove( SNAPSHOT_TEST_FILE );
+
+    for( i=0 ; i<ms.numUnique; i++){
+        temp = lineStabQuery( loaded->root, ms.points[i] );
+        if( temp>max )
+            max = temp;
+    }
+
+    freeTree( loaded );
+    freeTree( pt );
+    freeMoveSegments( &ms );
+    return max;
+}
+
+/* carTraversalFlatTree
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Same algorithm as carTraversalTree using the array backed FlatSegmentTree
+ */
+int carTraversalFlatTree( double moveSequence[], int numMoves ){
+    int i, max, temp;
+    MoveSegments ms;
+    FlatSegmentTree* st;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    st = constructFlatSegmentTree( ms.points, 0, ms.numUnique-1 );
+    for( i=0 ; i<numMoves; i++)
+        insertFlatSegment( st, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+
+    max = -1;
+    for( i=0 ; i<ms.numUnique; i++)
+    {
+        temp = flatLineStabQuery( st, ms.points[i] );
+        if( temp>max ){
+            max = temp;
+        }
+    }
+
+    freeFlatSegmentTree( st );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalOnline
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Streams the segments into a FlatSegmentTree and reads the maximum coverage from its root after every insert
+ * instead of running a query per point at the end.  The answer so far is known after each move.
+ */
+int carTraversalOnline( double moveSequence[], int numMoves ){
+    int i, max = 0;
+    MoveSegments ms;
+    FlatSegmentTree* st;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    st = constructFlatSegmentTree( ms.points, 0, ms.numUnique-1 );
+    for( i=0 ; i<numMoves; i++){
+        insertFlatSegment( st, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+        max = flatMaxCoverage( st );
+    }
+
+    freeFlatSegmentTree( st );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalIntervalTree
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered (or -1 if the tree did not empty out at the end)
+ *
+ * Stores every move in an IntervalTree, reports the moves covering each point and then removes every move again
+ */
+int carTraversalIntervalTree( double moveSequence[], int numMoves ){
+    int i, max, temp;
+    MoveSegments ms;
+    Interval* covering = (Interval*) malloc( (numMoves+1)*sizeof( Interval ) );
+    Interval iv;
+    IntervalTree* it = createIntervalTree( );
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    for( i=0 ; i<numMoves; i++){
+        iv.low = ms.segmentStartArray[i];
+        iv.high = ms.segmentEndArray[i];
+        iv.id = i;
+        insertInterval( it, iv );
+    }
+
+    max = -1;
+    for( i=0 ; i<ms.numUnique; i++)
+    {
+        temp = stabIntervals( it, ms.points[i], covering, numMoves );
+        if( temp>max ){
+            max = temp;
+        }
+    }
+
+    for( i=0 ; i<numMoves; i++){
+        iv.low = ms.segmentStartArray[i];
+        iv.high = ms.segmentEndArray[i];
+        iv.id = i;
+        removeInterval( it, iv );
+    }
+    if( it->size!=0 || it->root!=NULL )
+        max = -1;
+
+    freeIntervalTree( it );
+    free( covering );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalDynamic
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Feeds each move straight into a DynamicSegmentTree as it is made: no points are collected, sorted or
+ * deduplicated first, and the maximum coverage so far is available after every move.
+ */
+int carTraversalDynamic( double moveSequence[], int numMoves ){
+    double current = 0, next = 0;
+    int i, max;
+    DynamicSegmentTree* dt = createDynamicSegmentTree( );
+
+    for( i=0 ; i<numMoves; i++)
+    {
+        current = next;
+        next = next + moveSequence[i];
+        if( current < next )
+            insertDynamicSegment( dt, current, next );
+        else
+            insertDynamicSegment( dt, next, current );
+    }
+    max = dynamicMaxCoverage( dt );
+
+    freeDynamicSegmentTree( dt );
+    return max;
+}
+
+/* carTraversalBatch
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Same as carTraversalTree but answers all of the (sorted) stabbing queries with one lineStabQueryBatch
+ */
+int carTraversalBatch( double moveSequence[], int numMoves ){
+    int i, max;
+    MoveSegments ms;
+    int* counts;
+    Tree* pt;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    pt = createTreeFromTNode( constructSegmentTree( ms.points, 0, ms.numUnique-1 ) );
+    pt->type = SEGMENT;
+    for( i=0 ; i<numMoves; i++)
+        insertSegment( pt->root, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+
+    counts = (int*) malloc( ms.numUnique*sizeof( int ) );
+    lineStabQueryBatch( pt->root, ms.points, ms.numUnique, counts );
+    max = -1;
+    for( i=0 ; i<ms.numUnique; i++)
+    {
+        if( counts[i]>max ){
+            max = counts[i];
+        }
+    }
+
+    freeTree( pt );
+    free( counts );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalParallel
+ * input: the move sequence, the number of moves, the number of threads
+ * output: the maximum number of times any point is covered
+ *
+ * Same as carTraversalBatch but builds and fills the tree with constructSegmentTreeParallel/insertSegmentsParallel
+ */
+int carTraversalParallel( double moveSequence[], int numMoves, int numThreads ){
+    int i, max;
+    MoveSegments ms;
+    int* counts;
+    Tree* pt;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    pt = createTreeFromTNode( constructSegmentTreeParallel( ms.points, 0, ms.numUnique-1, numThreads ) );
+    pt->type = SEGMENT;
+    insertSegmentsParallel( pt->root, ms.segmentStartArray, ms.segmentEndArray, numMoves, numThreads );
+
+    counts = (int*) malloc( ms.numUnique*sizeof( int ) );
+    lineStabQueryBatch( pt->root, ms.points, ms.numUnique, counts );
+    max = -1;
+    for( i=0 ; i<ms.numUnique; i++)
+    {
+        if( counts[i]>max ){
+            max = counts[i];
+        }
+    }
+
+    freeTree( pt );
+    free( counts );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalFenwick
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Same algorithm as carTraversalTree using a FenwickTree for the stabbing counts
+ */
+int carTraversalFenwick( double moveSequence[], int numMoves ){
+    int i, max, temp;
+    MoveSegments ms;
+    FenwickTree* ft;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+
+    ft = constructFenwickTree( ms.points, 0, ms.numUnique-1 );
+    for( i=0 ; i<numMoves; i++)
+        insertFenwickSegment( ft, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+
+    max = -1;
+    for( i=0 ; i<ms.numUnique; i++)
+    {
+        temp = fenwickStabQuery( ft, ms.points[i] );
+        if( temp>max ){
+            max = temp;
+        }
+    }
+
+    freeFenwickTree( ft );
+    freeMoveSegments( &ms );
+
+    return max;
+}
+
+/* carTraversalSweep
+ * input: the move sequence, the number of moves
+ * output: the maximum number of times any point is covered
+ *
+ * Computes the same answer as carTraversalTree without building a tree: the segment starts and ends are sorted
+ * separately and merged, adding one at every start and subtracting one after every end.  A start is taken
+ * before an end at the same position since the segments are closed.
+ */
+int carTraversalSweep( double moveSequence[], int numMoves ){
+    double current = 0, next = 0;
+    int i, j, cover = 0, max = 0;
+    double* segmentStartArray = (double*) malloc( numMoves*sizeof( double ) );
+    double* segmentEndArray = (double*) malloc( numMoves*sizeof( double ) );
+
+    for( i=0 ; i<numMoves; i++)
+    {
+        current = next;
+        next = next + moveSequence[i];
+        segmentStartArray[i] = current < next ? current : next;
+        segmentEndArray[i] = current < next ? next : current;
+    }
+    qsort( segmentStartArray, numMoves, sizeof(double), cmpDoubles );
+    qsort( segmentEndArray, numMoves, sizeof(double), cmpDoubles );
+
+    /* every end is >= its start, so the starts always run out first */
+    for( i=0, j=0; i<numMoves; ){
+        if( segmentStartArray[i] <= segmentEndArray[j] ){
+            cover++;
+            i++;
+            if( cover>max )
+                max = cover;
+        }
+        else{
+            cover--;
+            j++;
+        }
+    }
+
+    free( segmentStartArray );
+    free( segmentEndArray );
+    return max;
+}
+
+/* generateMoves
+ * input: the number of moves
+ * output: an array of numMoves random moves (this is malloc-ed so must be freed eventually!)
+ *
+ * Random walk with steps in [-250,250] in quarter units, seeded so runs are reproducible
+ */
+double* generateMoves( int numMoves ){
+    int i;
+    double* moveSequence = (double*) malloc( numMoves*sizeof( double ) );
+
+    srand( 2124 );
+    for( i=0; i<numMoves; i++ )
+        moveSequence[i] = (rand() % 2001 - 1000) / 4.0;
+    return moveSequence;
+}
+
+/* benchSegmentTrees
+ * input: the number of moves to generate
+ * output: none
+ *
+ * Times every benchmarked engine of carTraversalEngines on the same random move sequence against the pointer
+ * segment tree and reports the bytes each stabbing-count structure needs for the resulting number of unique points
+ */
+void benchSegmentTrees( int numMoves ){
+    double* moveSequence = generateMoves( numMoves );
+    int solutions[NUM_CAR_TRAVERSAL_ENGINES];
+    double times[NUM_CAR_TRAVERSAL_ENGINES];
+    double start;
+    int i, leaves = 1;
+    MoveSegments ms;
+
+    for( i=0; i<NUM_CAR_TRAVERSAL_ENGINES; i++ ){
+        if( !carTraversalEngines[i].isBenchmarked )
+            continue;
+        start = benchSeconds( );
+        solutions[i] = carTraversalEngines[i].run( moveSequence, numMoves );
+        times[i] = benchSeconds( ) - start;
+    }
+
+    /* the pointer tree is a full binary tree with one leaf per point, the flat tree has 2*(next power of 2) slots */
+    createMoveSegments( moveSequence, numMoves, &ms );
+    while( leaves < ms.numUnique )
+        leaves *= 2;
+
+    printf( "Max coverage of %d random moves (%d unique points): %d\n", numMoves, ms.numUnique, solutions[0] );
+    for( i=0; i<NUM_CAR_TRAVERSAL_ENGINES; i++ ){
+        if( !carTraversalEngines[i].isBenchmarked )
+            continue;
+        if( solutions[i]!=solutions[0] )
+            printf( "FAILURE - %s computed %d instead of %d\n", carTraversalEngines[i].description, solutions[i], solutions[0] );
+        printf( "Time of the %s (in seconds): %lf, speedup: %.2lfx\n", carTraversalEngines[i].description, times[i], times[0]/times[i] );
+    }
+    printf( "Memory of the pointer segment tree / flat segment tree / Fenwick tree (in bytes): %ld / %ld / %ld\n\n",
+        (long)(2*ms.numUnique-1)*(long)sizeof(TNode), 2L*leaves*(2*sizeof(double) + 2*sizeof(int)),
+        (long)ms.numUnique*(long)sizeof(double) + (ms.numUnique+2L)*(long)sizeof(int) );
+
+    freeMoveSegments( &ms );
+    free( moveSequence );
+}
+
+/* overlapIntervalsLinear
+ * input: an array of intervals, the number of intervals, the ends of a closed query range, an array for the results and its capacity
+ * output: the number of intervals that overlap the query range
+ *
+ * Linear scan baseline for overlapIntervals
+ */
+int overlapIntervalsLinear( Interval* intervals, int numIntervals, double queryLow, double queryHigh, Interval* results, int maxResults ){
+    int i, count = 0;
+    for( i=0; i<numIntervals; i++ ){
+        if( intervals[i].low <= queryHigh && intervals[i].high >= queryLow ){
+            if( count < maxResults )
+                results[count] = intervals[i];
+            count++;
+        }
+    }
+    return count;
+}
+
+/* benchIntervalTree
+ * input: the number of intervals, the number of queries
+ * output: none
+ *
+ * Times stab and range overlap reporting of an IntervalTree against a linear scan over random intervals
+ * (half of which are removed again so deletes are exercised)
+ */
+void benchIntervalTree( int numIntervals, int numQueries ){
+    Interval* intervals = (Interval*) malloc( numIntervals*sizeof( Interval ) );
+    Interval* results = (Interval*) malloc( numIntervals*sizeof( Interval ) );
+    double* queryLow = (double*) malloc( numQueries*sizeof( double ) );
+    double* queryHigh = (double*) malloc( numQueries*sizeof( double ) );
+    IntervalTree* it = createIntervalTree( );
+    double start, end;
+    double treeTime, linearTime;
+    long treeReported = 0, linearReported = 0;
+    int i, remaining = numIntervals/2;
+
+    srand( 2124 );
+    for( i=0; i<numIntervals; i++ ){
+        intervals[i].low = rand() % 1000000;
+        intervals[i].high = intervals[i].low + rand() % 1000;
+        intervals[i].id = i;
+        insertInterval( it, intervals[i] );
+    }
+    /* remove the first half and keep the rest at the front of the array for the linear scan */
+    for( i=0; i<numIntervals-remaining; i++ ){
+        if( !removeInterval( it, intervals[i] ) )
+            printf( "FAILURE - interval %d was not found for removal\n", i );
+    }
+    memmove( intervals, &intervals[numIntervals-remaining], remaining*sizeof( Interval ) );
+
+    for( i=0; i<numQueries; i++ ){
+        queryLow[i] = rand() % 1000000;
+        queryHigh[i] = i%2==0 ? queryLow[i] : queryLow[i] + rand() % 5000; /* even queries are stabs */
+    }
+
+    start = benchSeconds( );
+    for( i=0; i<numQueries; i++ )
+        treeReported += overlapIntervals( it, queryLow[i], queryHigh[i], results, numIntervals );
+    end = benchSeconds( );
+    treeTime = (end - start);
+
+    start = benchSeconds( );
+    for( i=0; i<numQueries; i++ )
+        linearReported += overlapIntervalsLinear( intervals, remaining, queryLow[i], queryHigh[i], results, numIntervals );
+    end = benchSeconds( );
+    linearTime = (end - start);
+
+    if( treeReported!=linearReported )
+        printf( "FAILURE - interval tree reported %ld intervals instead of %ld\n", treeReported, linearReported );
+    printf( "Intervals stored: %d, queries: %d, intervals reported: %ld\n", it->size, numQueries, treeReported );
+    printf( "Interval tree query latency (in ns): %.1lf\n", 1e9*treeTime/numQueries );
+    printf( "Linear scan query latency (in ns): %.1lf\n", 1e9*linearTime/numQueries );
+    printf( "Speedup: %.2lfx\n\n", linearTime/treeTime );
+
+    freeIntervalTree( it );
+    free( intervals );
+    free( results );
+    free( queryLow );
+    free( queryHigh );
+}
+
+/* benchCarTraversalSweep
+ * input: the number of moves to generate
+ * output: none
+ *
+ * Times the sweep line against the flat segment tree (the pointer tree is too large at this scale)
+ */
+void benchCarTraversalSweep( int numMoves ){
+    double* moveSequence = generateMoves( numMoves );
+    double start, end;
+    int flatSolution, sweepSolution;
+    double flatTime, sweepTime;
+
+    start = benchSeconds( );
+    flatSolution = carTraversalFlatTree( moveSequence, numMoves );
+    end = benchSeconds( );
+    flatTime = (end - start);
+
+    start = benchSeconds( );
+    sweepSolution = carTraversalSweep( moveSequence, numMoves );
+    end = benchSeconds( );
+    sweepTime = (end - start);
+
+    if( sweepSolution!=flatSolution )
+        printf( "FAILURE - sweep line computed %d instead of %d\n", sweepSolution, flatSolution );
+    printf( "Max coverage of %d random moves: %d\n", numMoves, flatSolution );
+    printf( "Flat segment tree time (in seconds): %lf\n", flatTime );
+    printf( "Sweep line time (in seconds): %lf\n", sweepTime );
+    printf( "Speedup (sweep): %.2lfx\n\n", flatTime/sweepTime );
+
+    free( moveSequence );
+}
+
+/* benchParallelSegmentTree
+ * input: the number of moves to generate
+ * output: none
+ *
+ * Times building the pointer segment tree and inserting every segment with 1, 2, 4, ... threads up to the
+ * number of online cores (and always at least 2 so the threaded path is exercised).  The sequential
+ * constructSegmentTree/insertSegment pair is the baseline for the speedups.  Answers are checked outside the
+ * timed region.
+ */
+void benchParallelSegmentTree( int numMoves ){
+    double* moveSequence = generateMoves( numMoves );
+    int numCores, numThreads, i, max, expected = -1;
+    int* counts;
+    double start, buildTime, insertTime, baseTime = 0;
+    TNode* root;
+    Tree* pt;
+    MoveSegments ms;
+
+    createMoveSegments( moveSequence, numMoves, &ms );
+    counts = (int*) malloc( ms.numUnique*sizeof( int ) );
+    numCores = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    printf( "Segments: %d, unique points: %d, online cores: %d\n", numMoves, ms.numUnique, numCores );
+
+    /* numThreads==0 is the sequential baseline */
+    for( numThreads=0; numThreads<=numCores || numThreads<=2; numThreads = numThreads==0 ? 1 : 2*numThreads ){
+        start = benchSeconds( );
+        root = numThreads==0 ? constructSegmentTree( ms.points, 0, ms.numUnique-1 ) : constructSegmentTreeParallel( ms.points, 0, ms.numUnique-1, numThreads );
+        buildTime = benchSeconds( ) - start;
+
+        start = benchSeconds( );
+        if( numThreads==0 ){
+            for( i=0 ; i<numMoves; i++)
+                insertSegment( root, ms.segmentStartArray[i], ms.segmentEndArray[i] );
+        }
+        else
+            insertSegmentsParallel( root, ms.segmentStartArray, ms.segmentEndArray, numMoves, numThreads );
+        insertTime = benchSeconds( ) - start;
+
+        pt = createTreeFromTNode( root );
+        pt->type = SEGMENT;
+        lineStabQueryBatch( pt->root, ms.points, ms.numUnique, counts );
+        max = -1;
+        for( i=0 ; i<ms.numUnique; i++)
+            max = counts[i]>max ? counts[i] : max;
+        freeTree( pt );
+
+        if( numThreads==0 ){
+            expected = max;
+            baseTime = buildTime + insertTime;
+            printf( "Sequential build (in seconds): %lf, insert (in seconds): %lf, max coverage: %d\n", buildTime, insertTime, max );
+            continue;
+        }
+        if( max!=expected )
+            printf( "FAILURE - %d threads computed a max coverage of %d instead of %d\n", numThreads, max, expected );
+        printf( "%d thread(s) build (in seconds): %lf, insert (in seconds): %lf, speedup: %.2lfx\n", numThreads, buildTime, insertTime, baseTime/(buildTime + insertTime) );
+    }
+    printf("\n");
+
+    free( counts );
+    free( moveSequence );
+    freeMoveSegments( &ms );
+}
+
+/* benchMoveLoader
+ * input: the number of moves to generate
+ * output: none
+ *
+ * Writes random moves as a text file and as a binary file, then times reading the text file with fscanf and
+ * with loadMoveFile (one thread and one per online core) and mapping the binary file.  Every result is compared
+ * against the generated moves outside the timed region.
+ */
+void benchMoveLoader( int numMoves ){
+    double* moveSequence = generateMoves( numMoves );
+    double* scannedSequence;
+    int numCores = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    int i, numScanned, scannedSolution;
+    double start, scanfTime, textTime, threadedTime, binaryTime;
+    MoveFile *text, *threaded, *binary;
+    FILE* out = fopen( BENCH_TEXT_FILE, "w" );
+
+    if( out==NULL ){
+        printf("File %s could not be created.\n", BENCH_TEXT_FILE);
+        free( moveSequence );
+        return;
+    }
+    fprintf( out, "%d -1\n", numMoves );
+    for( i=0; i<numMoves; i++ )
+        fprintf( out, "%.2lf ", moveSequence[i] );
+    fclose( out );
+    writeMoveFileBinary( BENCH_BINARY_FILE, moveSequence, numMoves, -1 );
+
+    start = benchSeconds( );
+    readArrayScanf( BENCH_TEXT_FILE, &scannedSequence, &scannedSolution, &numScanned );
+    scanfTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    text = loadMoveFile( BENCH_TEXT_FILE, 1 );
+    textTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    threaded = loadMoveFile( BENCH_TEXT_FILE, numCores );
+    threadedTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    binary = loadMoveFile( BENCH_BINARY_FILE, 1 );
+    binaryTime = benchSeconds( ) - start;
+
+    if( numScanned!=numMoves || memcmp( scannedSequence, moveSequence, numMoves*sizeof( double ) )!=0 )
+        printf( "FAILURE - fscanf did not read back the generated moves\n" );
+    if( text->numMoves!=numMoves || memcmp( text->moves, moveSequence, numMoves*sizeof( double ) )!=0 )
+        printf( "FAILURE - the text loader did not read back the generated moves\n" );
+    if( threaded->numMoves!=numMoves || memcmp( threaded->moves, moveSequence, numMoves*sizeof( double ) )!=0 )
+        printf( "FAILURE - the threaded text loader did not read back the generated moves\n" );
+    if( binary->numMoves!=numMoves || memcmp( binary->moves, moveSequence, numMoves*sizeof( double ) )!=0 )
+        printf( "FAILURE - the binary loader did not read back the generated moves\n" );
+
+    printf( "Moves: %d, online cores: %d\n", numMoves, numCores );
+    printf( "fscanf text time (in seconds): %lf\n", scanfTime );
+    printf( "Bulk text loader time (in seconds): %lf\n", textTime );
+    printf( "Bulk text loader with %d thread(s) time (in seconds): %lf\n", numCores, threadedTime );
+    printf( "Binary zero-copy load time (in seconds): %lf\n", binaryTime );
+    printf( "Speedup (text / threaded text / binary): %.2lfx / %.2lfx / %.2lfx\n\n", scanfTime/textTime, scanfTime/threadedTime, scanfTime/binaryTime );
+
+    freeMoveFile( text );
+    freeMoveFile( threaded );
+    freeMoveFile( binary );
+    free( scannedSequence );
+    free( moveSequence );
+    remove( BENCH_TEXT_FILE );
+    remove( BENCH_BINARY_FILE );
+}
+
+/* benchCoordinateCompression
+ * input: the number of moves to generate
+ * output: none
+ *
+ * Times qsort+removeDuplicates against sortUniqueDoubles on the positions of a random walk and checks that both
+ * give the same points array
+ */
+void benchCoordinateCompression( int numMoves ){
+    double* moveSequence = generateMoves( numMoves );
+    double* sorted = (double*) malloc( (numMoves+1)*sizeof( double ) );
+    double* radixSorted = (double*) malloc( (numMoves+1)*sizeof( double ) );
+    int i, numUnique, numRadixUnique;
+    double start, qsortTime, radixTime;
+
+    sorted[0] = 0;
+    for( i=0; i<numMoves; i++ )
+        sorted[i+1] = sorted[i] + moveSequence[i];
+    memcpy( radixSorted, sorted, (numMoves+1)*sizeof( double ) );
+
+    start = benchSeconds( );
+    qsort( sorted, numMoves+1, sizeof(double), cmpDoubles );
+    numUnique = removeDuplicates( sorted, numMoves+1 );
+    qsortTime = benchSeconds( ) - start;
+
+    start = benchSeconds( );
+    numRadixUnique = sortUniqueDoubles( radixSorted, numMoves+1 );
+    radixTime = benchSeconds( ) - start;
+
+    if( numRadixUnique!=numUnique || memcmp( sorted, radixSorted, numUnique*sizeof( double ) )!=0 )
+        printf( "FAILURE - the radix sort produced a different points array (%d instead of %d unique points)\n", numRadixUnique, numUnique );
+    printf( "Points: %d, unique points: %d\n", numMoves+1, numUnique );
+    printf( "qsort + removeDuplicates time (in seconds): %lf\n", qsortTime );
+    printf( "Radix sort with fused dedup time (in seconds): %lf\n", radixTime );
+    printf( "Speedup: %.2lfx\n\n", qsortTime/radixTime );
+
+    free( moveSequence );
+    free( sorted );
+    free( radixSorted );
+}
+
 int removeDuplicates( double* points, int oldSize ){
     int i, j = 0;
 
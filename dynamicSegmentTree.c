@@ -0,0 +1,257 @@
+#include "dynamicSegmentTree.h"
+#include "stats.h"
+
+/*
+ * maxPrefix of an empty subtree (small enough to never win a max, large enough not to overflow when added to)
+ */
+int const DNODE_NO_PREFIX = -1000000000;
+
+/**********  Helper functions for a dynamic segment tree **********/
+void freeDNodes( DNode* root );
+DNode* addEndpoint( DNode* root, double key, int startDelta, int endDelta );
+void updateDNode( DNode* x );
+DNode* rebalanceDNode( DNode* x );
+DNode* rightRotateDNode( DNode* oldRoot );
+DNode* leftRotateDNode( DNode* oldRoot );
+int dNodeHeight( DNode* x );
+int dNodeSum( DNode* x );
+int dNodeMaxPrefix( DNode* x );
+void addDNodeMemory( DNode* root, MemoryUsage* mu );
+
+/* createDynamicSegmentTree
+ * input: none
+ * output: a pointer to a DynamicSegmentTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Creates a new empty DynamicSegmentTree.  Unlike constructSegmentTree no endpoints are needed up front: the
+ * tree is an AVL tree keyed by endpoint where every node counts the segments starting and ending there and is
+ * augmented with its subtree's sum and maximum prefix sum.  A segment with endpoints never seen before just
+ * adds (at most) two nodes, so the tree never has to be rebuilt.
+ */
+DynamicSegmentTree* createDynamicSegmentTree( )
+{
+    DynamicSegmentTree* dt = (DynamicSegmentTree*)malloc( sizeof(DynamicSegmentTree) );
+    dt->root = NULL;
+    dt->numSegments = 0;
+    return dt;
+}
+
+/* freeDynamicSegmentTree
+ * input: a pointer to a DynamicSegmentTree
+ * output: none
+ *
+ * frees the given DynamicSegmentTree
+ */
+void freeDynamicSegmentTree( DynamicSegmentTree* dt )
+{
+    freeDNodes( dt->root );
+    free( dt );
+}
+
+void freeDNodes( DNode* root )
+{
+    if( root==NULL )
+        return;
+    freeDNodes( root->pLeft );
+    freeDNodes( root->pRight );
+    free( root );
+}
+
+/* insertDynamicSegment and removeDynamicSegment
+ * input: a pointer to a DynamicSegmentTree, a double segmentStart, and a double segmentEnd
+ * output: none
+ *
+ * Inserts (or takes back a previously inserted) closed line segment from segmentStart to segmentEnd in O(log n).
+ * Endpoints whose counts drop back to zero stay in the tree and simply contribute nothing.
+ */
+void insertDynamicSegment( DynamicSegmentTree* dt, double segmentStart, double segmentEnd )
+{
+    dt->root = addEndpoint( dt->root, segmentStart, 1, 0 );
+    dt->root = addEndpoint( dt->root, segmentEnd, 0, 1 );
+    dt->numSegments++;
+}
+
+void removeDynamicSegment( DynamicSegmentTree* dt, double segmentStart, double segmentEnd )
+{
+    dt->root = addEndpoint( dt->root, segmentStart, -1, 0 );
+    dt->root = addEndpoint( dt->root, segmentEnd, 0, -1 );
+    dt->numSegments--;
+}
+
+/* dynamicStabQuery
+ * input: a pointer to a DynamicSegmentTree, a double queryPoint
+ * output: the number of line segments that contain queryPoint
+ *
+ * Counts the segments starting at or before queryPoint minus the ones that ended before it, in one walk down
+ */
+int dynamicStabQuery( DynamicSegmentTree* dt, double queryPoint )
+{
+    DNode* x = dt->root;
+    int total = 0;
+
+    while( x!=NULL ){
+        if( queryPoint < x->key )
+            x = x->pLeft;
+        else if( queryPoint == x->key )
+            return total + dNodeSum( x->pLeft ) + x->startCnt;
+        else{
+            total += dNodeSum( x->pLeft ) + x->startCnt - x->endCnt;
+            x = x->pRight;
+        }
+    }
+    return total;
+}
+
+/* dynamicMaxCoverage
+ * input: a pointer to a DynamicSegmentTree
+ * output: the largest number of segments covering any point
+ *
+ * O(1): the coverage peaks at an endpoint, so it is the root's maximum prefix sum
+ */
+int dynamicMaxCoverage( DynamicSegmentTree* dt )
+{
+    if( dt->root==NULL )
+        return 0;
+    return dt->root->maxPrefix;
+}
+
+/* addEndpoint
+ * input: a DNode, an endpoint, the changes to its start and end counts
+ * output: the new root of the subtree
+ *
+ * Finds or creates the node for key, applies the changes and rebalances on the way back up
+ */
+DNode* addEndpoint( DNode* root, double key, int startDelta, int endDelta )
+{
+    if( root==NULL ){
+        root = (DNode*)malloc( sizeof(DNode) );
+        STATS_INC( allocations );
+        root->pLeft = NULL;
+        root->pRight = NULL;
+        root->key = key;
+        root->startCnt = startDelta;
+        root->endCnt = endDelta;
+        updateDNode( root );
+        return root;
+    }
+
+    if( key < root->key )
+        root->pLeft = addEndpoint( root->pLeft, key, startDelta, endDelta );
+    else if( key > root->key )
+        root->pRight = addEndpoint( root->pRight, key, startDelta, endDelta );
+    else{
+        root->startCnt += startDelta;
+        root->endCnt += endDelta;
+    }
+    return rebalanceDNode( root );
+}
+
+/* updateDNode
+ * input: a DNode whose children are up to date
+ * output: none
+ *
+ * Recomputes the height and the augmented sum/maxPrefix of x.  Within one key the starts are applied before the
+ * ends (the segments are closed), so the best prefix ending at x is the left sum plus startCnt.
+ */
+void updateDNode( DNode* x )
+{
+    int leftSum = dNodeSum( x->pLeft );
+    int best = dNodeMaxPrefix( x->pLeft );
+    int atKey = leftSum + x->startCnt;
+    int afterKey = atKey - x->endCnt;
+
+    x->height = 1 + ( dNodeHeight( x->pLeft ) > dNodeHeight( x->pRight ) ? dNodeHeight( x->pLeft ) : dNodeHeight( x->pRight ) );
+    x->sum = afterKey + dNodeSum( x->pRight );
+
+    if( atKey > best )
+        best = atKey;
+    if( x->pRight!=NULL && afterKey + x->pRight->maxPrefix > best )
+        best = afterKey + x->pRight->maxPrefix;
+    x->maxPrefix = best;
+}
+
+/* rebalanceDNode
+ * input: a DNode whose children are balanced
+ * output: the new root of the balanced subtree
+ */
+DNode* rebalanceDNode( DNode* x )
+{
+    int balance = dNodeHeight( x->pLeft ) - dNodeHeight( x->pRight );
+
+    if( balance > 1 ){
+        if( dNodeHeight( x->pLeft->pLeft ) < dNodeHeight( x->pLeft->pRight ) )
+            x->pLeft = leftRotateDNode( x->pLeft );
+        return rightRotateDNode( x );
+    }
+    if( balance < -1 ){
+        if( dNodeHeight( x->pRight->pRight ) < dNodeHeight( x->pRight->pLeft ) )
+            x->pRight = rightRotateDNode( x->pRight );
+        return leftRotateDNode( x );
+    }
+    updateDNode( x );
+    return x;
+}
+
+/* rightRotateDNode and leftRotateDNode
+ * input: a DNode
+ * output: the new root of the subtree
+ *
+ * Performs specified rotation and recomputes the augmented data of the two nodes that moved
+ */
+DNode* rightRotateDNode( DNode* oldRoot )
+{
+    DNode* newRoot = oldRoot->pLeft;
+    oldRoot->pLeft = newRoot->pRight;
+    newRoot->pRight = oldRoot;
+    updateDNode( oldRoot );
+    updateDNode( newRoot );
+    return newRoot;
+}
+
+DNode* leftRotateDNode( DNode* oldRoot )
+{
+    DNode* newRoot = oldRoot->pRight;
+    oldRoot->pRight = newRoot->pLeft;
+    newRoot->pLeft = oldRoot;
+    updateDNode( oldRoot );
+    updateDNode( newRoot );
+    return newRoot;
+}
+
+int dNodeHeight( DNode* x )
+{
+    return x==NULL ? 0 : x->height;
+}
+
+int dNodeSum( DNode* x )
+{
+    return x==NULL ? 0 : x->sum;
+}
+
+int dNodeMaxPrefix( DNode* x )
+{
+    return x==NULL ? DNODE_NO_PREFIX : x->maxPrefix;
+}
+
+/* memoryUsageDynamicSegmentTree
+ * input: a pointer to a DynamicSegmentTree
+ * output: the bytes used by the DynamicSegmentTree and its DNodes (one element per distinct endpoint)
+ */
+MemoryUsage memoryUsageDynamicSegmentTree( DynamicSegmentTree* dt )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    addNodeMemory( &mu, dt, sizeof(DynamicSegmentTree) );
+    addDNodeMemory( dt->root, &mu );
+    return mu;
+}
+
+void addDNodeMemory( DNode* root, MemoryUsage* mu )
+{
+    if( root==NULL )
+        return;
+    mu->numElements++;
+    addNodeMemory( mu, root, sizeof(DNode) );
+    addDNodeMemory( root->pLeft, mu );
+    addDNodeMemory( root->pRight, mu );
+}
@@ -0,0 +1,43 @@
+#ifndef _dynamicSegmentTree_h
+#define _dynamicSegmentTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "memoryUsage.h"
+
+typedef struct DNode
+{
+    struct DNode* pLeft;    /* left child (endpoints < key) */
+    struct DNode* pRight;   /* right child (endpoints > key) */
+    int height;             /* max number of nodes on path from this node down to a leaf of the tree */
+
+    double key;             /* an endpoint of one or more inserted line segments */
+    int startCnt;           /* number of inserted line segments starting at key */
+    int endCnt;             /* number of inserted line segments ending at key */
+
+    int sum;                /* sum of startCnt - endCnt over the subtree */
+    int maxPrefix;          /* largest coverage at any key of the subtree, relative to the coverage just before the subtree */
+}  DNode;
+
+typedef struct DynamicSegmentTree
+{
+    DNode* root;            /* the root of this tree (it will be a NULL if the tree is empty) */
+    int numSegments;        /* number of line segments currently inserted */
+}  DynamicSegmentTree;
+
+/**********  Functions for creating/freeing a dynamic segment tree **********/
+DynamicSegmentTree* createDynamicSegmentTree( );
+void freeDynamicSegmentTree( DynamicSegmentTree* dt );
+
+/**********  Functions for using a dynamic segment tree **********/
+void insertDynamicSegment( DynamicSegmentTree* dt, double segmentStart, double segmentEnd );
+void removeDynamicSegment( DynamicSegmentTree* dt, double segmentStart, double segmentEnd );
+int dynamicStabQuery( DynamicSegmentTree* dt, double queryPoint );
+int dynamicMaxCoverage( DynamicSegmentTree* dt );
+
+/**********  Functions for measuring the memory of a dynamic segment tree **********/
+MemoryUsage memoryUsageDynamicSegmentTree( DynamicSegmentTree* dt );
+
+#endif
@@ -0,0 +1,124 @@
+#include "fenwickTree.h"
+
+/**********  Helper functions for a Fenwick tree **********/
+int lowerBoundPoint( FenwickTree* ft, double x );
+void addFenwick( FenwickTree* ft, int i, int delta );
+
+/* constructFenwickTree
+ * input: an array of sorted unique doubles, an int low, an int high
+ * output: a pointer to a FenwickTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Builds an empty stabbing-count structure over points[low..high] with the same interface as a segment tree.
+ * A segment adds 1 at its first point and -1 after its last point, so the coverage of a point is the prefix
+ * sum up to it: both are O(log n) on one flat int array with no pointers.
+ */
+FenwickTree* constructFenwickTree( double* points, int low, int high )
+{
+    FenwickTree* ft = (FenwickTree*)malloc( sizeof(FenwickTree) );
+
+    ft->size = high-low+1;
+    ft->points = (double*)malloc( ft->size*sizeof(double) );
+    memcpy( ft->points, &points[low], ft->size*sizeof(double) );
+    ft->tree = (int*)calloc( ft->size+2, sizeof(int) );
+
+    return ft;
+}
+
+/* freeFenwickTree
+ * input: a pointer to a FenwickTree
+ * output: none
+ *
+ * frees the given FenwickTree
+ */
+void freeFenwickTree( FenwickTree* ft )
+{
+    free( ft->points );
+    free( ft->tree );
+    free( ft );
+}
+
+/* insertFenwickSegment
+ * input: a pointer to a FenwickTree, a double segmentStart, and a double segmentEnd
+ * output: none
+ *
+ * Inserts given line segment from segmentStart to segmentEnd (same semantics as insertSegment)
+ */
+void insertFenwickSegment( FenwickTree* ft, double segmentStart, double segmentEnd )
+{
+    int first = lowerBoundPoint( ft, segmentStart );
+    int last = lowerBoundPoint( ft, segmentEnd );
+
+    /* last is the index of the last point <= segmentEnd */
+    if( last==ft->size || ft->points[last] > segmentEnd )
+        last--;
+    if( first > last )
+        return; /* the segment contains no points */
+
+    addFenwick( ft, first+1, 1 );
+    addFenwick( ft, last+2, -1 );
+}
+
+/* fenwickStabQuery
+ * input: a pointer to a FenwickTree, a double queryPoint
+ * output: the number of line segments that contain queryPoint
+ *
+ * queryPoint must be one of the points the tree was built with (0 is returned otherwise)
+ */
+int fenwickStabQuery( FenwickTree* ft, double queryPoint )
+{
+    int i = lowerBoundPoint( ft, queryPoint );
+    int total = 0;
+
+    if( i==ft->size || ft->points[i]!=queryPoint )
+        return 0;
+
+    for( i=i+1; i>0; i -= i & -i )
+        total += ft->tree[i];
+    return total;
+}
+
+/* lowerBoundPoint
+ * input: a pointer to a FenwickTree, a double x
+ * output: the index of the first point >= x (size if there is none)
+ */
+int lowerBoundPoint( FenwickTree* ft, double x )
+{
+    int low = 0, high = ft->size, mid;
+
+    while( low < high ){
+        mid = (low + high)/2;
+        if( ft->points[mid] < x )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/* addFenwick
+ * input: a pointer to a FenwickTree, a 1-based position, an int delta
+ * output: none
+ *
+ * Adds delta to the difference stored at position i (position size+1 is a sentinel that is never read)
+ */
+void addFenwick( FenwickTree* ft, int i, int delta )
+{
+    for( ; i<=ft->size; i += i & -i )
+        ft->tree[i] += delta;
+}
+
+/* memoryUsageFenwickTree
+ * input: a pointer to a FenwickTree
+ * output: the bytes used by the FenwickTree, its copy of the points and its counts (one element per point)
+ */
+MemoryUsage memoryUsageFenwickTree( FenwickTree* ft )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = ft->size;
+    addNodeMemory( &mu, ft, sizeof(FenwickTree) );
+    addNodeMemory( &mu, ft->points, ft->size*sizeof(double) );
+    addNodeMemory( &mu, ft->tree, (ft->size+2)*sizeof(int) );
+    return mu;
+}
@@ -0,0 +1,28 @@
+#ifndef _fenwickTree_h
+#define _fenwickTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "memoryUsage.h"
+
+typedef struct FenwickTree
+{
+    double* points;         /* copy of the sorted unique points, points[i] is stored at position i+1 of the tree */
+    int* tree;              /* binary indexed tree over the differences of the coverage counts (tree[0] is unused) */
+    int size;               /* number of points */
+}  FenwickTree;
+
+/**********  Functions for creating/freeing a Fenwick tree **********/
+FenwickTree* constructFenwickTree( double* points, int low, int high );
+void freeFenwickTree( FenwickTree* ft );
+
+/**********  Functions for using a Fenwick tree **********/
+void insertFenwickSegment( FenwickTree* ft, double segmentStart, double segmentEnd );
+int fenwickStabQuery( FenwickTree* ft, double queryPoint );
+
+/**********  Functions for measuring the memory of a Fenwick tree **********/
+MemoryUsage memoryUsageFenwickTree( FenwickTree* ft );
+
+#endif
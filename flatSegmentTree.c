@@ -0,0 +1,157 @@
+#include "flatSegmentTree.h"
+
+/**********  Helper functions for a flat segment tree **********/
+void buildFlatNode( FlatSegmentTree* st, double* points, int i, int low, int high );
+void addFlatNode( FlatSegmentTree* st, int i, double segmentStart, double segmentEnd, int delta );
+
+/* constructFlatSegmentTree
+ * input: an array of sorted unique doubles, an int low, an int high
+ * output: a pointer to a FlatSegmentTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Builds the same tree as constructSegmentTree (same split of the points at every level) but stores it as an
+ * implicit tree: node i has children 2i+1 and 2i+2 and only its low, high, cnt and maxCnt are kept, in four
+ * arrays carved out of a single allocation.
+ */
+FlatSegmentTree* constructFlatSegmentTree( double* points, int low, int high )
+{
+    FlatSegmentTree* st = (FlatSegmentTree*)malloc( sizeof(FlatSegmentTree) );
+    int leaves = 1;
+    char* block;
+
+    /* splitting at the mid point gives a depth of ceil(log2(#points)), so 2*leaves slots are enough */
+    while( leaves < high-low+1 )
+        leaves *= 2;
+    st->capacity = 2*leaves;
+
+    block = (char*)malloc( st->capacity*(2*sizeof(double) + 2*sizeof(int)) );
+    st->low = (double*)block;
+    st->high = st->low + st->capacity;
+    st->cnt = (int*)(st->high + st->capacity);
+    st->maxCnt = st->cnt + st->capacity;
+
+    buildFlatNode( st, points, 0, low, high );
+    return st;
+}
+
+/* freeFlatSegmentTree
+ * input: a pointer to a FlatSegmentTree
+ * output: none
+ *
+ * frees the given FlatSegmentTree
+ */
+void freeFlatSegmentTree( FlatSegmentTree* st )
+{
+    free( st->low ); /* start of the single block holding all four arrays */
+    free( st );
+}
+
+void buildFlatNode( FlatSegmentTree* st, double* points, int i, int low, int high )
+{
+    int mid = (high - low)/2 + low;
+
+    st->low[i] = points[low];
+    st->high[i] = points[high];
+    st->cnt[i] = 0;
+    st->maxCnt[i] = 0;
+    if( low!=high ){
+        buildFlatNode( st, points, 2*i+1, low, mid );
+        buildFlatNode( st, points, 2*i+2, mid+1, high );
+    }
+}
+
+/* insertFlatSegment
+ * input: a pointer to a FlatSegmentTree, a double segmentStart, and a double segmentEnd
+ * output: none
+ *
+ * Inserts given line segment from segmentStart to segmentEnd (same semantics as insertSegment)
+ */
+void insertFlatSegment( FlatSegmentTree* st, double segmentStart, double segmentEnd )
+{
+    addFlatNode( st, 0, segmentStart, segmentEnd, 1 );
+}
+
+/* addFlatSegment
+ * input: a pointer to a FlatSegmentTree, a double segmentStart, a double segmentEnd, an int delta
+ * output: none
+ *
+ * Range add: adds delta to the coverage of every point from segmentStart to segmentEnd (use -1 to take back a
+ * segment that was inserted before).  cnt acts as the lazy tag of each canonical node.  It never has to be
+ * pushed down, because a point's coverage is the sum of the cnt on its root path, so the subtree maximum is
+ * cnt[i] + max(maxCnt of the children) and is fixed up on the way back from the O(log n) canonical nodes.
+ */
+void addFlatSegment( FlatSegmentTree* st, double segmentStart, double segmentEnd, int delta )
+{
+    addFlatNode( st, 0, segmentStart, segmentEnd, delta );
+}
+
+void addFlatNode( FlatSegmentTree* st, int i, double segmentStart, double segmentEnd, int delta )
+{
+    int left = 2*i+1, right = 2*i+2;
+
+    if( segmentEnd < st->low[i] || segmentStart > st->high[i] )
+        return;
+
+    if( segmentStart <= st->low[i] && st->high[i] <= segmentEnd ){
+        st->cnt[i] += delta;
+        st->maxCnt[i] += delta;
+        return;
+    }
+
+    if( st->low[i]!=st->high[i] ){
+        addFlatNode( st, left, segmentStart, segmentEnd, delta );
+        addFlatNode( st, right, segmentStart, segmentEnd, delta );
+        st->maxCnt[i] = st->cnt[i] + ( st->maxCnt[left] > st->maxCnt[right] ? st->maxCnt[left] : st->maxCnt[right] );
+    }
+}
+
+/* flatMaxCoverage
+ * input: a pointer to a FlatSegmentTree
+ * output: the largest number of segments covering any of the tree's points
+ *
+ * O(1): read from the root, so it can be asked after every insert
+ */
+int flatMaxCoverage( FlatSegmentTree* st )
+{
+    return st->maxCnt[0];
+}
+
+/* flatLineStabQuery
+ * input: a pointer to a FlatSegmentTree, a double queryPoint
+ * output: the number of line segments that contain queryPoint
+ *
+ * At most one child's range contains queryPoint, so the query is a single walk down the implicit tree
+ */
+int flatLineStabQuery( FlatSegmentTree* st, double queryPoint )
+{
+    int i = 0, total = 0;
+
+    if( queryPoint < st->low[0] || queryPoint > st->high[0] )
+        return 0;
+
+    while( true ){
+        total += st->cnt[i];
+        if( st->low[i]==st->high[i] )
+            return total;
+        if( queryPoint <= st->high[2*i+1] )
+            i = 2*i+1;
+        else if( queryPoint >= st->low[2*i+2] )
+            i = 2*i+2;
+        else
+            return total; /* queryPoint falls between the two children */
+    }
+}
+
+/* memoryUsageFlatSegmentTree
+ * input: a pointer to a FlatSegmentTree
+ * output: the bytes used by the FlatSegmentTree and its node arrays (one element per node slot)
+ */
+MemoryUsage memoryUsageFlatSegmentTree( FlatSegmentTree* st )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = st->capacity;
+    addNodeMemory( &mu, st, sizeof(FlatSegmentTree) );
+    addNodeMemory( &mu, st->low, st->capacity*(2*sizeof(double) + 2*sizeof(int)) );
+    return mu;
+}
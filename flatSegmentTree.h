@@ -0,0 +1,32 @@
+#ifndef _flatSegmentTree_h
+#define _flatSegmentTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "memoryUsage.h"
+
+typedef struct FlatSegmentTree
+{
+    double* low;            /* low[i] is the left end of the range of node i */
+    double* high;           /* high[i] is the right end of the range of node i (low[i]==high[i] for a leaf) */
+    int* cnt;               /* cnt[i] has the same meaning as TNode's cnt */
+    int* maxCnt;            /* maxCnt[i] is the largest number of segments covering any point in the range of node i */
+    int capacity;           /* number of node slots in each array (the children of i are 2i+1 and 2i+2) */
+}  FlatSegmentTree;
+
+/**********  Functions for creating/freeing a flat segment tree **********/
+FlatSegmentTree* constructFlatSegmentTree( double* points, int low, int high );
+void freeFlatSegmentTree( FlatSegmentTree* st );
+
+/**********  Functions for using a flat segment tree **********/
+void insertFlatSegment( FlatSegmentTree* st, double segmentStart, double segmentEnd );
+void addFlatSegment( FlatSegmentTree* st, double segmentStart, double segmentEnd, int delta );
+int flatLineStabQuery( FlatSegmentTree* st, double queryPoint );
+int flatMaxCoverage( FlatSegmentTree* st );
+
+/**********  Functions for measuring the memory of a flat segment tree **********/
+MemoryUsage memoryUsageFlatSegmentTree( FlatSegmentTree* st );
+
+#endif
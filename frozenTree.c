@@ -0,0 +1,191 @@
+#include "frozenTree.h"
+#include "keyIntern.h"
+
+/**********  Helper functions for freezing a tree **********/
+int countTNodes( TNode* root );
+void collectInorder( TNode* root, Data** sorted, int* pPos );
+int fillEytzinger( FrozenTree* ft, Data** sorted, int pos, int k );
+int compareFrozenKey( char* key, FrozenNode* x );
+size_t frozenArrayBytes( int size );
+
+/* freezeTree
+ * input: a pointer to an AVL, PERSISTENT or SPLAY Tree
+ * output: a pointer to a FrozenTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Copies the keys of t into one contiguous array laid out in Eytzinger order, so a search walks down an
+ * implicit tree (children of i at 2i and 2i+1) instead of chasing pLeft/pRight pointers across the heap.
+ * The Data* are shared with t, so t must outlive the FrozenTree.  Later changes to t are not reflected.
+ */
+FrozenTree* freezeTree( Tree* t )
+{
+    FrozenTree* ft;
+    int size = countTNodes( t->root ), pos = 0;
+    Data** sorted = (Data**)malloc( (size+1)*sizeof(Data*) );
+
+    collectInorder( t->root, sorted, &pos );
+    ft = freezeSortedData( sorted, size );
+    free( sorted );
+
+    return ft;
+}
+
+/* freezeSortedData
+ * input: an array of Data* sorted by key, the number of Data*
+ * output: a pointer to a FrozenTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Lays the keys out in Eytzinger order in O(size).  The Data* are shared, so they must outlive the FrozenTree.
+ */
+FrozenTree* freezeSortedData( Data** sorted, int size )
+{
+    FrozenTree* ft = (FrozenTree*)malloc( sizeof(FrozenTree) );
+
+    ft->size = size;
+    ft->nodes = (FrozenNode*)aligned_alloc( FROZEN_LINE_BYTES, frozenArrayBytes( size ) );
+    fillEytzinger( ft, sorted, 0, 1 );
+
+    return ft;
+}
+
+/* freeFrozenTree
+ * input: a pointer to a FrozenTree
+ * output: none
+ *
+ * frees the given FrozenTree (but not the Data, which still belongs to the original tree)
+ */
+void freeFrozenTree( FrozenTree* ft )
+{
+    free( ft->nodes );
+    free( ft );
+}
+
+/* searchFrozenTree
+ * input: a pointer to a FrozenTree, a Data* tData
+ * output: the Data* with the same key as tData or, if no such key exists, NULL
+ *
+ * Walks down the Eytzinger array.  A key compare reads only the node's own cache line unless the key is longer
+ * than the inline bytes.  The 4 descendants two levels below k are nodes 4k..4k+3, one cache line each, and
+ * every one of them that lies inside the array is prefetched while the current key is being compared.
+ */
+Data* searchFrozenTree( FrozenTree* ft, Data* tData )
+{
+    int k = 1;
+    int cmp;
+    long d;
+
+    while( k <= ft->size ){
+        for( d=4*(long)k; d<=ft->size && d<4*(long)k+4; d++ )
+            __builtin_prefetch( ft->nodes + d );
+        cmp = compareFrozenKey( tData->key, &ft->nodes[k] );
+        if( cmp==0 )
+            return ft->nodes[k].data;
+        k = 2*k + (cmp > 0);
+    }
+    return NULL;
+}
+
+/* compareFrozenKey
+ * input: a key, a pointer to a FrozenNode
+ * output: <0, 0 or >0 as strcmp( key, x->data->key )
+ *
+ * Compares against the inline bytes first.  Only a key that fills all of them (no NUL inside) and ties with
+ * the probe needs the rest of the key from data->key.
+ */
+int compareFrozenKey( char* key, FrozenNode* x )
+{
+    int cmp = strncmp( key, x->key, FROZEN_KEY_BYTES );
+
+    if( cmp!=0 || x->key[FROZEN_KEY_BYTES-1]=='\0' )
+        return cmp;
+    return strcmp( key+FROZEN_KEY_BYTES, x->data->key+FROZEN_KEY_BYTES );
+}
+
+/* countTNodes
+ * input: a pointer to a TNode
+ * output: the number of TNodes in the subtree
+ */
+int countTNodes( TNode* root )
+{
+    int size = 0;
+
+    collectInorder( root, NULL, &size );
+    return size;
+}
+
+/* collectInorder
+ * input: a pointer to a TNode, an array of Data* (or NULL to only count), a pointer to the next free index
+ * output: none
+ *
+ * Stores the Data* of the subtree in sorted order.  The walk keeps its own stack (PERSISTENT TNodes have no
+ * parent pointers for a TreeIterator, and a SPLAY tree can be too deep to recurse over).
+ */
+void collectInorder( TNode* root, Data** sorted, int* pPos )
+{
+    int top = 0, capacity = 64;
+    TNode** stack = (TNode**)malloc( capacity*sizeof(TNode*) );
+    TNode* x = root;
+
+    while( x!=NULL || top>0 ){
+        for( ; x!=NULL; x=x->pLeft ){
+            if( top==capacity ){
+                capacity *= 2;
+                stack = (TNode**)realloc( stack, capacity*sizeof(TNode*) );
+            }
+            stack[top++] = x;
+        }
+        x = stack[--top];
+        if( sorted!=NULL )
+            sorted[*pPos] = x->data;
+        (*pPos)++;
+        x = x->pRight;
+    }
+    free( stack );
+}
+
+/* fillEytzinger
+ * input: a pointer to a FrozenTree, the sorted Data*, the next sorted index to place, an Eytzinger index k
+ * output: the next sorted index after the subtree at k has been filled
+ *
+ * An inorder walk of the implicit tree visits the Eytzinger slots in key order
+ */
+int fillEytzinger( FrozenTree* ft, Data** sorted, int pos, int k )
+{
+    if( k > ft->size )
+        return pos;
+    pos = fillEytzinger( ft, sorted, pos, 2*k );
+    ft->nodes[k].data = sorted[pos];
+    strncpy( ft->nodes[k].key, sorted[pos]->key, FROZEN_KEY_BYTES );
+    pos++;
+    return fillEytzinger( ft, sorted, pos, 2*k+1 );
+}
+
+/* frozenArrayBytes
+ * input: the number of keys
+ * output: the bytes allocated for the node array (nodes[0] is unused), rounded up to whole cache lines as
+ *         aligned_alloc requires
+ */
+size_t frozenArrayBytes( int size )
+{
+    return ((size+1)*sizeof(FrozenNode) + FROZEN_LINE_BYTES-1) & ~(size_t)(FROZEN_LINE_BYTES-1);
+}
+
+/* memoryUsageFrozenTree
+ * input: a pointer to a FrozenTree
+ * output: the bytes used by the FrozenTree, its node array and the Data/keys it points to
+ *
+ * The Data and keys are shared with the Tree that was frozen, they are counted so the layouts compare fairly.
+ */
+MemoryUsage memoryUsageFrozenTree( FrozenTree* ft )
+{
+    MemoryUsage mu;
+    int i;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = ft->size;
+    addNodeMemory( &mu, ft, sizeof(FrozenTree) );
+    addArrayMemory( &mu, ft->nodes, (ft->size+1)*sizeof(FrozenNode), frozenArrayBytes( ft->size ) );
+    for( i=1; i<=ft->size; i++ ){
+        addPayloadMemory( &mu, ft->nodes[i].data, sizeof(Data) );
+        addKeyMemory( &mu, ft->nodes[i].data );
+    }
+    return mu;
+}
@@ -0,0 +1,37 @@
+#ifndef _frozenTree_h
+#define _frozenTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "data.h"
+#include "tree.h"
+
+#define FROZEN_LINE_BYTES 64    /* the node array starts on a cache line, so every FrozenNode fills exactly one line */
+#define FROZEN_KEY_BYTES 56     /* key bytes stored inline in a FrozenNode (keys up to 55 chars never leave the array) */
+
+typedef struct FrozenNode
+{
+    char key[FROZEN_KEY_BYTES]; /* first FROZEN_KEY_BYTES bytes of data->key (NUL padded), the rest is only read on a tie */
+    Data* data;                 /* pointer to the data stored in the original tree */
+}  FrozenNode;
+
+typedef struct FrozenTree
+{
+    FrozenNode* nodes;      /* keys in Eytzinger (BFS) order, nodes[1] is the root and the children of i are 2i and 2i+1 */
+    int size;               /* number of keys stored (nodes[0] is unused) */
+}  FrozenTree;
+
+/**********  Functions for creating/freeing a frozen tree **********/
+FrozenTree* freezeTree( Tree* t );
+FrozenTree* freezeSortedData( Data** sorted, int size );
+void freeFrozenTree( FrozenTree* ft );
+
+/**********  Functions for searching a frozen tree **********/
+Data* searchFrozenTree( FrozenTree* ft, Data* tData );
+
+/**********  Functions for measuring the memory of a frozen tree **********/
+MemoryUsage memoryUsageFrozenTree( FrozenTree* ft );
+
+#endif
@@ -0,0 +1,959 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "benchHarness.h"
+#include "data.h"
+#include "tree.h"
+#include "priorityQueue.h"
+#include "frozenTree.h"
+#include "bTree.h"
+#include "flatSegmentTree.h"
+#include "fenwickTree.h"
+#include "dynamicSegmentTree.h"
+#include "intervalTree.h"
+#include "shardedMap.h"
+
+/* Harness defaults (override with "./harness [case] [numOps]") */
+#define HARNESS_OPS 100000       /* number of timed operations per repetition */
+#define HARNESS_WARMUPS 1        /* number of untimed warmup repetitions */
+#define HARNESS_REPS 5           /* number of timed repetitions */
+#define HARNESS_CHECKS 100       /* number of query results compared against a brute force count in validate */
+#define HARNESS_SHARDS 16        /* number of shards of the sharded map cases (split at the quantiles of the keys) */
+
+typedef struct HarnessState
+{
+    int numOps;
+    Data** data;            /* numOps keys in shuffled order */
+    Data* queries;          /* numOps lookups sharing the keys of data, in a different order */
+    Tree* tree;             /* AVL, PERSISTENT, SPLAY, SEGMENT or HUFFMAN tree */
+    FrozenTree* frozen;
+    BTree* btree;
+    ShardedMap* shards;
+    PriorityQueue* pq;
+    TNode** pqNodes;        /* nodes inserted into/removed from pq */
+    double* starts;         /* segments/intervals from a random walk */
+    double* ends;
+    double* points;         /* the sorted unique endpoints */
+    int numUnique;
+    FlatSegmentTree* flat;
+    FenwickTree* fenwick;
+    DynamicSegmentTree* dynamic;
+    IntervalTree* intervals;
+    Interval* reported;     /* scratch space for interval tree results */
+    int* results;           /* result of the i-th timed query */
+    long count;             /* number of timed operations that succeeded */
+}  HarnessState;
+
+/**********  Functions for setting up/tearing down the harness state **********/
+HarnessState* createState( int numOps );
+void createKeys( HarnessState* s );
+void createSegments( HarnessState* s );
+void fillAVLTree( HarnessState* s, treeType type, bool withIndex );
+void fillPQ( HarnessState* s );
+void teardownState( void* state );
+MemoryUsage memoryState( void* state );
+int cmpPoints( const void* a, const void* b );
+
+/**********  Functions for the tree cases **********/
+void* setupAVLInsert( int numOps );
+void* setupAVLFilled( int numOps );
+void* setupAVLIndexed( int numOps );
+void* setupPersistentInsert( int numOps );
+void* setupSplayInsert( int numOps );
+void* setupSplayFilled( int numOps );
+void* setupFrozen( int numOps );
+void* setupBTreeInsert( int numOps );
+void* setupBTreeFilled( int numOps );
+void* setupShardInsert( int numOps );
+void* setupShardFilled( int numOps );
+void runAVLInsert( void* state, int i );
+void runAVLSearch( void* state, int i );
+void runAVLRemove( void* state, int i );
+void runPersistentInsert( void* state, int i );
+void runFrozenSearch( void* state, int i );
+void runBTreeInsert( void* state, int i );
+void runBTreeSearch( void* state, int i );
+void runBTreeRemove( void* state, int i );
+void runShardInsert( void* state, int i );
+void runShardSearch( void* state, int i );
+void runShardRemove( void* state, int i );
+int validateAllFound( void* state, int numOps );
+int validateTreeContents( void* state, int numOps );
+int validateAVLEmpty( void* state, int numOps );
+int validateBTreeContents( void* state, int numOps );
+int validateBTreeEmpty( void* state, int numOps );
+int validateShardContents( void* state, int numOps );
+int validateShardEmpty( void* state, int numOps );
+int countAVLErrors( TNode* root );
+
+/**********  Functions for the priority queue/Huffman cases **********/
+void* setupPQInsert( int numOps );
+void* setupPQFilled( int numOps );
+void* setupHuffman( int numOps );
+void runPQInsert( void* state, int i );
+void runPQRemove( void* state, int i );
+void runHuffmanMerge( void* state, int i );
+int validatePQDrain( void* state, int numOps );
+int validatePQRemoved( void* state, int numOps );
+int validateHuffman( void* state, int numOps );
+
+/**********  Functions for the segment/interval cases **********/
+void* setupSegmentInsert( int numOps );
+void* setupSegmentFilled( int numOps );
+void* setupFlatInsert( int numOps );
+void* setupFlatFilled( int numOps );
+void* setupFenwickInsert( int numOps );
+void* setupFenwickFilled( int numOps );
+void* setupDynamicInsert( int numOps );
+void* setupDynamicFilled( int numOps );
+void* setupIntervalInsert( int numOps );
+void* setupIntervalFilled( int numOps );
+void runSegmentInsert( void* state, int i );
+void runSegmentQuery( void* state, int i );
+void runFlatInsert( void* state, int i );
+void runFlatQuery( void* state, int i );
+void runFenwickInsert( void* state, int i );
+void runFenwickQuery( void* state, int i );
+void runDynamicInsert( void* state, int i );
+void runDynamicQuery( void* state, int i );
+void runIntervalInsert( void* state, int i );
+void runIntervalStab( void* state, int i );
+int validateSegmentStructure( void* state, int numOps );
+int validateQueryResults( void* state, int numOps );
+int stabStructure( HarnessState* s, double queryPoint );
+int stabBruteForce( HarnessState* s, double queryPoint );
+double queryPointFor( HarnessState* s, int i );
+
+BenchCase benchCases[] = {
+    { "avl-insert", setupAVLInsert, runAVLInsert, validateTreeContents, teardownState, memoryState },
+    { "avl-search", setupAVLFilled, runAVLSearch, validateAllFound, teardownState, memoryState },
+    { "avl-hash-search", setupAVLIndexed, runAVLSearch, validateAllFound, teardownState, memoryState },
+    { "avl-remove", setupAVLFilled, runAVLRemove, validateAVLEmpty, teardownState, memoryState },
+    { "splay-insert", setupSplayInsert, runAVLInsert, validateTreeContents, teardownState, memoryState },
+    { "splay-search", setupSplayFilled, runAVLSearch, validateAllFound, teardownState, memoryState },
+    { "splay-remove", setupSplayFilled, runAVLRemove, validateAVLEmpty, teardownState, memoryState },
+    { "persistent-insert", setupPersistentInsert, runPersistentInsert, validateTreeContents, teardownState, memoryState },
+    { "frozen-search", setupFrozen, runFrozenSearch, validateAllFound, teardownState, memoryState },
+    { "btree-insert", setupBTreeInsert, runBTreeInsert, validateBTreeContents, teardownState, memoryState },
+    { "btree-search", setupBTreeFilled, runBTreeSearch, validateAllFound, teardownState, memoryState },
+    { "btree-remove", setupBTreeFilled, runBTreeRemove, validateBTreeEmpty, teardownState, memoryState },
+    { "shard-insert", setupShardInsert, runShardInsert, validateShardContents, teardownState, memoryState },
+    { "shard-search", setupShardFilled, runShardSearch, validateAllFound, teardownState, memoryState },
+    { "shard-remove", setupShardFilled, runShardRemove, validateShardEmpty, teardownState, memoryState },
+    { "pq-insert", setupPQInsert, runPQInsert, validatePQDrain, teardownState, memoryState },
+    { "pq-remove", setupPQFilled, runPQRemove, validatePQRemoved, teardownState, memoryState },
+    { "huffman-merge", setupHuffman, runHuffmanMerge, validateHuffman, teardownState, memoryState },
+    { "segment-insert", setupSegmentInsert, runSegmentInsert, validateSegmentStructure, teardownState, memoryState },
+    { "segment-query", setupSegmentFilled, runSegmentQuery, validateQueryResults, teardownState, memoryState },
+    { "flat-insert", setupFlatInsert, runFlatInsert, validateSegmentStructure, teardownState, memoryState },
+    { "flat-query", setupFlatFilled, runFlatQuery, validateQueryResults, teardownState, memoryState },
+    { "fenwick-insert", setupFenwickInsert, runFenwickInsert, validateSegmentStructure, teardownState, memoryState },
+    { "fenwick-query", setupFenwickFilled, runFenwickQuery, validateQueryResults, teardownState, memoryState },
+    { "dynamic-insert", setupDynamicInsert, runDynamicInsert, validateSegmentStructure, teardownState, memoryState },
+    { "dynamic-query", setupDynamicFilled, runDynamicQuery, validateQueryResults, teardownState, memoryState },
+    { "interval-insert", setupIntervalInsert, runIntervalInsert, validateSegmentStructure, teardownState, memoryState },
+    { "interval-stab", setupIntervalFilled, runIntervalStab, validateQueryResults, teardownState, memoryState },
+};
+
+int main( int argc, char *argv[] )
+{
+    int numCases = sizeof(benchCases)/sizeof(benchCases[0]);
+    char* name = argc>1 && strcmp( argv[1], "all" )!=0 ? argv[1] : NULL;
+    int numOps = argc>2 ? atoi( argv[2] ) : HARNESS_OPS;
+    BenchResult r;
+    int i, numRun = 0;
+
+    if( numOps < 1 ){
+        printf( "The number of operations must be positive.\n" );
+        return -1;
+    }
+
+    printf( "BENCHMARK HARNESS: %d ops x %d reps (%d warmup), timer overhead %lu ns\n", numOps, HARNESS_REPS, HARNESS_WARMUPS, (unsigned long)benchTimerOverhead( ) );
+    for( i=0; i<numCases; i++ ){
+        if( name!=NULL && strcmp( name, benchCases[i].name )!=0 )
+            continue;
+        r = runBenchCase( &benchCases[i], numOps, HARNESS_WARMUPS, HARNESS_REPS );
+        printBenchResult( &benchCases[i], &r );
+        numRun++;
+    }
+    if( numRun==0 ){
+        printf( "No benchmark case named %s\n", name );
+        return -1;
+    }
+    return 0;
+}
+
+
+/**********  Functions for setting up/tearing down the harness state **********/
+
+HarnessState* createState( int numOps ){
+    HarnessState* s = (HarnessState*)calloc( 1, sizeof(HarnessState) );
+    s->numOps = numOps;
+    return s;
+}
+
+/* createKeys
+ * input: the harness state
+ * output: none
+ *
+ * numOps distinct keys in shuffled order plus lookups for the same keys in another shuffled order
+ */
+void createKeys( HarnessState* s ){
+    int i, j;
+    Data* temp;
+
+    s->data = (Data**)malloc( s->numOps*sizeof(Data*) );
+    s->queries = (Data*)malloc( s->numOps*sizeof(Data) );
+    for( i=0; i<s->numOps; i++ ){
+        temp = createData( i, (char*)malloc( 31*sizeof(char) ) );
+        sprintf( temp->key, "key%010d", i );
+        s->data[i] = temp;
+    }
+
+    srand( 2124 );
+    for( i=s->numOps-1; i>0; i-- ){
+        j = rand() % (i+1);
+        temp = s->data[i];
+        s->data[i] = s->data[j];
+        s->data[j] = temp;
+    }
+    for( i=0; i<s->numOps; i++ )
+        s->queries[i] = *s->data[(int)(((long)i*7919) % s->numOps)];
+    /* 7919 is prime, so this is a permutation unless numOps is a multiple of it */
+    if( s->numOps % 7919==0 ){
+        for( i=0; i<s->numOps; i++ )
+            s->queries[i] = *s->data[s->numOps-1-i];
+    }
+}
+
+/* createSegments
+ * input: the harness state
+ * output: none
+ *
+ * numOps segments from a random walk (like the car traversal problem) and their sorted unique endpoints
+ */
+void createSegments( HarnessState* s ){
+    double current = 0, next = 0;
+    int i, j = 0;
+
+    s->starts = (double*)malloc( s->numOps*sizeof(double) );
+    s->ends = (double*)malloc( s->numOps*sizeof(double) );
+    s->points = (double*)malloc( (s->numOps+1)*sizeof(double) );
+    s->results = (int*)malloc( s->numOps*sizeof(int) );
+
+    srand( 2124 );
+    s->points[0] = 0;
+    for( i=0; i<s->numOps; i++ ){
+        current = next;
+        next += (rand() % 2001 - 1000) / 4.0;
+        s->starts[i] = current < next ? current : next;
+        s->ends[i] = current < next ? next : current;
+        s->points[i+1] = next;
+    }
+    qsort( s->points, s->numOps+1, sizeof(double), cmpPoints );
+    for( i=1; i<=s->numOps; i++ ){
+        if( s->points[i]!=s->points[j] )
+            s->points[++j] = s->points[i];
+    }
+    s->numUnique = j+1;
+}
+
+void fillAVLTree( HarnessState* s, treeType type, bool withIndex ){
+    int i;
+
+    createKeys( s );
+    s->tree = createTree( );
+    s->tree->type = type;
+    if( withIndex )
+        enableHashIndex( s->tree );
+    for( i=0; i<s->numOps; i++ )
+        insertTreeBalanced( s->tree, s->data[i] );
+}
+
+void fillPQ( HarnessState* s ){
+    int i;
+
+    s->pq = createPQ( );
+    s->pqNodes = (TNode**)malloc( (s->numOps+1)*sizeof(TNode*) );
+    srand( 2124 );
+    for( i=0; i<=s->numOps; i++ ){
+        s->pqNodes[i] = createTNode( );
+        s->pqNodes[i]->priority = rand() % 1000; /* small enough that a Huffman root of every node fits in an int */
+        s->pqNodes[i]->str = NULL;
+    }
+}
+
+/* teardownState
+ * input: the harness state
+ * output: none
+ *
+ * Frees whatever the setup and the timed operations left behind.  AVL, SPLAY and HUFFMAN trees, B-trees and
+ * sharded maps own their Data/str, every other structure leaves the keys to be freed here.
+ */
+void teardownState( void* state ){
+    HarnessState* s = (HarnessState*)state;
+    bool ownsData = false;
+    bool isHuffman = s->tree!=NULL && s->tree->type==HUFFMAN;
+    int i;
+
+    if( s->frozen!=NULL )
+        freeFrozenTree( s->frozen );
+    if( s->tree!=NULL ){
+        ownsData = s->tree->type==AVL || s->tree->type==SPLAY;
+        freeTree( s->tree );
+    }
+    if( s->btree!=NULL ){
+        ownsData = true;
+        freeBTree( s->btree );
+    }
+    if( s->shards!=NULL ){
+        ownsData = true;
+        freeShardedMap( s->shards );
+    }
+    if( s->data!=NULL ){
+        for( i=0; i<s->numOps && !ownsData; i++ ){
+            if( s->data[i]!=NULL )
+                freeData( s->data[i] );
+        }
+        free( s->data );
+        free( s->queries );
+    }
+    if( s->pq!=NULL ){
+        /* a Huffman tree was freed with freeTree above, otherwise every TNode handed to the queue is freed here */
+        for( i=0; i<=s->numOps && !isHuffman; i++ )
+            free( s->pqNodes[i] );
+        freePQ( s->pq );
+        free( s->pqNodes );
+    }
+    if( s->flat!=NULL )
+        freeFlatSegmentTree( s->flat );
+    if( s->fenwick!=NULL )
+        freeFenwickTree( s->fenwick );
+    if( s->dynamic!=NULL )
+        freeDynamicSegmentTree( s->dynamic );
+    if( s->intervals!=NULL )
+        freeIntervalTree( s->intervals );
+    free( s->reported );
+    free( s->starts );
+    free( s->ends );
+    free( s->points );
+    free( s->results );
+    free( s );
+}
+
+/* memoryState
+ * input: the harness state
+ * output: the memory used by the structure the case times
+ *
+ * A frozen case only counts the FrozenTree (not the Tree it was frozen from), a priority queue case counts the
+ * queue and the TNodes it holds.
+ */
+MemoryUsage memoryState( void* state ){
+    HarnessState* s = (HarnessState*)state;
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    if( s->frozen!=NULL )
+        mu = memoryUsageFrozenTree( s->frozen );
+    else if( s->tree!=NULL )
+        mu = memoryUsageTree( s->tree );
+    else if( s->btree!=NULL )
+        mu = memoryUsageBTree( s->btree );
+    else if( s->shards!=NULL )
+        mu = memoryUsageShardedMap( s->shards );
+    else if( s->pq!=NULL )
+        mu = memoryUsagePQ( s->pq );
+    else if( s->flat!=NULL )
+        mu = memoryUsageFlatSegmentTree( s->flat );
+    else if( s->fenwick!=NULL )
+        mu = memoryUsageFenwickTree( s->fenwick );
+    else if( s->dynamic!=NULL )
+        mu = memoryUsageDynamicSegmentTree( s->dynamic );
+    else if( s->intervals!=NULL )
+        mu = memoryUsageIntervalTree( s->intervals );
+    return mu;
+}
+
+int cmpPoints( const void* a, const void* b ){
+    double x = *(double*)a, y = *(double*)b;
+    return x < y ? -1 : x > y;
+}
+
+
+/**********  Functions for the tree cases **********/
+
+void* setupAVLInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createKeys( s );
+    s->tree = createTree( );
+    s->tree->type = AVL;
+    return s;
+}
+
+void* setupAVLFilled( int numOps ){
+    HarnessState* s = createState( numOps );
+    fillAVLTree( s, AVL, false );
+    return s;
+}
+
+void* setupAVLIndexed( int numOps ){
+    HarnessState* s = createState( numOps );
+    fillAVLTree( s, AVL, true );
+    return s;
+}
+
+void* setupPersistentInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createKeys( s );
+    s->tree = createTree( );
+    s->tree->type = PERSISTENT;
+    return s;
+}
+
+void* setupSplayInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createKeys( s );
+    s->tree = createTree( );
+    s->tree->type = SPLAY;
+    return s;
+}
+
+void* setupSplayFilled( int numOps ){
+    HarnessState* s = createState( numOps );
+    fillAVLTree( s, SPLAY, false );
+    return s;
+}
+
+void* setupFrozen( int numOps ){
+    HarnessState* s = createState( numOps );
+    fillAVLTree( s, AVL, false );
+    s->frozen = freezeTree( s->tree );
+    return s;
+}
+
+void* setupBTreeInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createKeys( s );
+    s->btree = createBTree( );
+    return s;
+}
+
+void* setupBTreeFilled( int numOps ){
+    HarnessState* s = createState( numOps );
+    int i;
+
+    createKeys( s );
+    s->btree = createBTree( );
+    for( i=0; i<numOps; i++ )
+        insertBTree( s->btree, s->data[i] );
+    return s;
+}
+
+/* setupShardInsert
+ * input: the number of operations
+ * output: the harness state with an empty sharded map split at the quantiles of the keys
+ */
+void* setupShardInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    char** keys;
+    int i;
+
+    createKeys( s );
+    keys = (char**)malloc( numOps*sizeof(char*) );
+    for( i=0; i<numOps; i++ )
+        keys[i] = s->data[i]->key;
+    s->shards = createShardedMapFromSample( HARNESS_SHARDS, keys, numOps );
+    free( keys );
+    return s;
+}
+
+void* setupShardFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupShardInsert( numOps );
+    int i;
+
+    for( i=0; i<numOps; i++ )
+        insertShardedMap( s->shards, s->data[i] );
+    return s;
+}
+
+void runAVLInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertTreeBalanced( s->tree, s->data[i] );
+}
+
+void runAVLSearch( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    if( searchTree( s->tree, &s->queries[i] )!=NULL )
+        s->count++;
+}
+
+void runAVLRemove( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    Data* d = removeTree( s->tree, s->queries[i].key );
+    if( d!=NULL ){
+        s->count++;
+        freeData( d );
+    }
+}
+
+void runPersistentInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    Tree* next = insertTreePersistent( s->tree, s->data[i] );
+    freeTree( s->tree );
+    s->tree = next;
+}
+
+void runFrozenSearch( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    if( searchFrozenTree( s->frozen, &s->queries[i] )!=NULL )
+        s->count++;
+}
+
+void runBTreeInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertBTree( s->btree, s->data[i] );
+}
+
+void runBTreeSearch( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    if( searchBTree( s->btree, &s->queries[i] )!=NULL )
+        s->count++;
+}
+
+void runBTreeRemove( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    Data* d = removeBTree( s->btree, s->queries[i].key );
+    if( d!=NULL ){
+        s->count++;
+        freeData( d );
+    }
+}
+
+void runShardInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertShardedMap( s->shards, s->data[i] );
+}
+
+void runShardSearch( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    if( searchShardedMap( s->shards, &s->queries[i] )!=NULL )
+        s->count++;
+}
+
+void runShardRemove( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    Data* d = removeShardedMap( s->shards, s->queries[i].key );
+    if( d!=NULL ){
+        s->count++;
+        freeData( d );
+    }
+}
+
+/* validateAllFound
+ * input: the harness state, the number of operations
+ * output: the number of timed lookups that missed
+ */
+int validateAllFound( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    return numOps - s->count;
+}
+
+/* validateTreeContents
+ * input: the harness state, the number of operations
+ * output: the number of balance/parent errors plus the number of keys that can't be found
+ */
+int validateTreeContents( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = s->tree->type==AVL ? countAVLErrors( s->tree->root ) : 0;
+
+    for( i=0; i<numOps; i++ ){
+        if( searchTreeRec( s->tree->root, &s->queries[i] )==NULL )
+            errors++;
+    }
+    return errors;
+}
+
+int validateAVLEmpty( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i;
+
+    /* removeTree freed every Data, so teardown must not */
+    for( i=0; i<numOps; i++ )
+        s->data[i] = NULL;
+    return (numOps - s->count) + (s->tree->root!=NULL);
+}
+
+int validateBTreeContents( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = s->btree->size!=numOps;
+
+    for( i=0; i<numOps; i++ ){
+        if( searchBTree( s->btree, &s->queries[i] )==NULL )
+            errors++;
+    }
+    return errors;
+}
+
+int validateBTreeEmpty( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    return (numOps - s->count) + (s->btree->size!=0);
+}
+
+/* validateShardContents
+ * input: the harness state, the number of operations
+ * output: the number of balance/parent errors in the shards plus the number of keys that can't be found
+ */
+int validateShardContents( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = 0;
+
+    for( i=0; i<s->shards->numShards; i++ )
+        errors += countAVLErrors( s->shards->shards[i].tree->root );
+    for( i=0; i<numOps; i++ ){
+        if( searchShardedMap( s->shards, &s->queries[i] )==NULL )
+            errors++;
+    }
+    return errors;
+}
+
+int validateShardEmpty( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = numOps - s->count;
+
+    /* removeShardedMap handed back every Data and runShardRemove freed it, so teardown must not */
+    for( i=0; i<numOps; i++ )
+        s->data[i] = NULL;
+    for( i=0; i<s->shards->numShards; i++ )
+        errors += s->shards->shards[i].tree->root!=NULL;
+    return errors;
+}
+
+/* countAVLErrors
+ * input: the root of an AVL tree
+ * output: the number of TNodes that are out of balance or have a wrong parent pointer
+ */
+int countAVLErrors( TNode* root ){
+    int cnt = 0;
+    if( root!=NULL ){
+        if( getBalance( root )>1 || getBalance( root )<-1 )
+            cnt++;
+        if( root->pLeft!=NULL && root->pLeft->pParent!=root )
+            cnt++;
+        if( root->pRight!=NULL && root->pRight->pParent!=root )
+            cnt++;
+        cnt += countAVLErrors( root->pLeft );
+        cnt += countAVLErrors( root->pRight );
+    }
+    return cnt;
+}
+
+
+/**********  Functions for the priority queue/Huffman cases **********/
+
+void* setupPQInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    fillPQ( s );
+    return s;
+}
+
+void* setupPQFilled( int numOps ){
+    HarnessState* s = createState( numOps );
+    int i;
+
+    fillPQ( s );
+    for( i=0; i<numOps; i++ )
+        insertPQ( s->pq, s->pqNodes[i] );
+    s->results = (int*)malloc( numOps*sizeof(int) );
+    return s;
+}
+
+/* setupHuffman
+ * input: the number of merges to time
+ * output: a harness state with numOps+1 leaves queued
+ */
+void* setupHuffman( int numOps ){
+    HarnessState* s = createState( numOps );
+    int i;
+
+    fillPQ( s );
+    for( i=0; i<=numOps; i++ )
+        insertPQ( s->pq, s->pqNodes[i] );
+    return s;
+}
+
+void runPQInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertPQ( s->pq, s->pqNodes[i] );
+}
+
+void runPQRemove( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = removePQ( s->pq )->priority;
+}
+
+/* runHuffmanMerge
+ * input: the harness state, the index of the operation
+ * output: none
+ *
+ * One step of building a Huffman tree: the two smallest TNodes are merged under a new TNode
+ */
+void runHuffmanMerge( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    TNode* min1 = removePQ( s->pq );
+    TNode* min2 = removePQ( s->pq );
+    TNode* root = createTNode( );
+
+    root->str = NULL;
+    root->priority = min1->priority + min2->priority;
+    attachChildNodes( root, min1, min2 );
+    insertPQ( s->pq, root );
+}
+
+/* validatePQDrain
+ * input: the harness state, the number of operations
+ * output: the number of TNodes removed out of order or missing
+ */
+int validatePQDrain( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int errors = 0, last = -1, removed = 0;
+    TNode* x;
+
+    while( !isEmptyPQ( s->pq ) ){
+        x = removePQ( s->pq );
+        if( x->priority < last )
+            errors++;
+        last = x->priority;
+        removed++;
+    }
+    return errors + (removed!=numOps);
+}
+
+int validatePQRemoved( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = !isEmptyPQ( s->pq );
+
+    for( i=1; i<numOps; i++ ){
+        if( s->results[i] < s->results[i-1] )
+            errors++;
+    }
+    return errors;
+}
+
+/* validateHuffman
+ * input: the harness state, the number of merges
+ * output: 0 if one tree with the total priority of the leaves is left, 1 otherwise
+ *
+ * The tree is handed to s->tree so teardown frees every TNode through freeTree.
+ */
+int validateHuffman( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    long total = 0;
+    int i, errors = 0;
+    TNode* root = removePQ( s->pq );
+
+    for( i=0; i<=numOps; i++ )
+        total += s->pqNodes[i]->priority;
+    if( !isEmptyPQ( s->pq ) || root->priority!=total )
+        errors++;
+    s->tree = createTreeFromTNode( root );
+    s->tree->type = HUFFMAN;
+    return errors;
+}
+
+
+/**********  Functions for the segment/interval cases **********/
+
+void* setupSegmentInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createSegments( s );
+    s->tree = createTreeFromTNode( constructSegmentTree( s->points, 0, s->numUnique-1 ) );
+    s->tree->type = SEGMENT;
+    return s;
+}
+
+void* setupSegmentFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupSegmentInsert( numOps );
+    int i;
+    for( i=0; i<numOps; i++ )
+        insertSegment( s->tree->root, s->starts[i], s->ends[i] );
+    return s;
+}
+
+void* setupFlatInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createSegments( s );
+    s->flat = constructFlatSegmentTree( s->points, 0, s->numUnique-1 );
+    return s;
+}
+
+void* setupFlatFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupFlatInsert( numOps );
+    int i;
+    for( i=0; i<numOps; i++ )
+        insertFlatSegment( s->flat, s->starts[i], s->ends[i] );
+    return s;
+}
+
+void* setupFenwickInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createSegments( s );
+    s->fenwick = constructFenwickTree( s->points, 0, s->numUnique-1 );
+    return s;
+}
+
+void* setupFenwickFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupFenwickInsert( numOps );
+    int i;
+    for( i=0; i<numOps; i++ )
+        insertFenwickSegment( s->fenwick, s->starts[i], s->ends[i] );
+    return s;
+}
+
+void* setupDynamicInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createSegments( s );
+    s->dynamic = createDynamicSegmentTree( );
+    return s;
+}
+
+void* setupDynamicFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupDynamicInsert( numOps );
+    int i;
+    for( i=0; i<numOps; i++ )
+        insertDynamicSegment( s->dynamic, s->starts[i], s->ends[i] );
+    return s;
+}
+
+void* setupIntervalInsert( int numOps ){
+    HarnessState* s = createState( numOps );
+    createSegments( s );
+    s->intervals = createIntervalTree( );
+    s->reported = (Interval*)malloc( numOps*sizeof(Interval) );
+    return s;
+}
+
+void* setupIntervalFilled( int numOps ){
+    HarnessState* s = (HarnessState*)setupIntervalInsert( numOps );
+    int i;
+    for( i=0; i<numOps; i++ )
+        runIntervalInsert( s, i );
+    return s;
+}
+
+void runSegmentInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertSegment( s->tree->root, s->starts[i], s->ends[i] );
+}
+
+void runSegmentQuery( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = lineStabQuery( s->tree->root, queryPointFor( s, i ) );
+}
+
+void runFlatInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertFlatSegment( s->flat, s->starts[i], s->ends[i] );
+}
+
+void runFlatQuery( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = flatLineStabQuery( s->flat, queryPointFor( s, i ) );
+}
+
+void runFenwickInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertFenwickSegment( s->fenwick, s->starts[i], s->ends[i] );
+}
+
+void runFenwickQuery( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = fenwickStabQuery( s->fenwick, queryPointFor( s, i ) );
+}
+
+void runDynamicInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    insertDynamicSegment( s->dynamic, s->starts[i], s->ends[i] );
+}
+
+void runDynamicQuery( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = dynamicStabQuery( s->dynamic, queryPointFor( s, i ) );
+}
+
+void runIntervalInsert( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    Interval iv;
+
+    iv.low = s->starts[i];
+    iv.high = s->ends[i];
+    iv.id = i;
+    insertInterval( s->intervals, iv );
+}
+
+void runIntervalStab( void* state, int i ){
+    HarnessState* s = (HarnessState*)state;
+    s->results[i] = stabIntervals( s->intervals, queryPointFor( s, i ), s->reported, s->numOps );
+}
+
+/* queryPointFor
+ * input: the harness state, the index of a query
+ * output: the endpoint the i-th query stabs (spread over every endpoint)
+ */
+double queryPointFor( HarnessState* s, int i ){
+    return s->points[(int)(((long)i*7919) % s->numUnique)];
+}
+
+/* validateSegmentStructure
+ * input: the harness state, the number of operations
+ * output: the number of sampled endpoints where the filled structure disagrees with a brute force count
+ */
+int validateSegmentStructure( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = 0;
+    double q;
+
+    for( i=0; i<HARNESS_CHECKS && i<numOps; i++ ){
+        q = queryPointFor( s, i );
+        if( stabStructure( s, q )!=stabBruteForce( s, q ) )
+            errors++;
+    }
+    return errors;
+}
+
+/* validateQueryResults
+ * input: the harness state, the number of operations
+ * output: the number of sampled timed queries whose result disagrees with a brute force count
+ */
+int validateQueryResults( void* state, int numOps ){
+    HarnessState* s = (HarnessState*)state;
+    int i, errors = 0;
+
+    for( i=0; i<HARNESS_CHECKS && i<numOps; i++ ){
+        if( s->results[i]!=stabBruteForce( s, queryPointFor( s, i ) ) )
+            errors++;
+    }
+    return errors;
+}
+
+int stabStructure( HarnessState* s, double queryPoint ){
+    if( s->tree!=NULL )
+        return lineStabQuery( s->tree->root, queryPoint );
+    if( s->flat!=NULL )
+        return flatLineStabQuery( s->flat, queryPoint );
+    if( s->fenwick!=NULL )
+        return fenwickStabQuery( s->fenwick, queryPoint );
+    if( s->dynamic!=NULL )
+        return dynamicStabQuery( s->dynamic, queryPoint );
+    return stabIntervals( s->intervals, queryPoint, s->reported, s->numOps );
+}
+
+int stabBruteForce( HarnessState* s, double queryPoint ){
+    int i, cnt = 0;
+    for( i=0; i<s->numOps; i++ ){
+        if( s->starts[i] <= queryPoint && queryPoint <= s->ends[i] )
+            cnt++;
+    }
+    return cnt;
+}
@@ -0,0 +1,204 @@
+#include "hashIndex.h"
+#include "keyIntern.h"
+
+/*
+ * Starting number of slots for a HashIndex and the maximum load (in percent) before it doubles
+ */
+int const HASH_STARTING_CAPACITY = 64;
+int const HASH_MAX_LOAD = 80;
+
+/**********  Helper functions for a hash index **********/
+int findHashSlot( HashIndex* h, char* key, unsigned int hash );
+void placeHashEntry( HashIndex* h, HashEntry e );
+void growHashIndex( HashIndex* h );
+
+/* createHashIndex
+ * input: none
+ * output: a pointer to a HashIndex (this is malloc-ed so must be freed eventually!)
+ *
+ * Creates a new empty HashIndex.  A HashIndex maps a key to the TNode of an AVL tree that holds it.
+ */
+HashIndex* createHashIndex( )
+{
+    HashIndex* h = (HashIndex*)malloc( sizeof(HashIndex) );
+    h->capacity = HASH_STARTING_CAPACITY;
+    h->size = 0;
+    h->entries = (HashEntry*)calloc( h->capacity, sizeof(HashEntry) );
+    return h;
+}
+
+/* freeHashIndex
+ * input: a pointer to a HashIndex
+ * output: none
+ *
+ * frees the given HashIndex (the TNodes belong to the tree and are not freed)
+ */
+void freeHashIndex( HashIndex* h )
+{
+    free( h->entries );
+    free( h );
+}
+
+/* hashKey
+ * input: a string
+ * output: the 32-bit FNV-1a hash of the string (see keyHash, stored and probe Data use dataKeyHash so interned keys are not rehashed)
+ */
+unsigned int hashKey( char* key )
+{
+    return keyHash( key );
+}
+
+/* searchHashIndex
+ * input: a pointer to a HashIndex, a Data* tData
+ * output: the TNode holding tData->key or NULL if the key is not indexed
+ *
+ * An interned probe key is not rehashed (see dataKeyHash)
+ */
+TNode* searchHashIndex( HashIndex* h, Data* tData )
+{
+    int i = findHashSlot( h, tData->key, dataKeyHash( tData ) );
+    return i==-1 ? NULL : h->entries[i].node;
+}
+
+/* insertHashIndex
+ * input: a pointer to a HashIndex, a TNode
+ * output: none
+ *
+ * Indexes node under node->data->key.  The key must not already be indexed.
+ */
+void insertHashIndex( HashIndex* h, TNode* node )
+{
+    HashEntry e;
+
+    if( 100*(h->size+1) > HASH_MAX_LOAD*h->capacity )
+        growHashIndex( h );
+
+    e.node = node;
+    e.hash = dataKeyHash( node->data );
+    e.dist = 0;
+    placeHashEntry( h, e );
+    h->size++;
+}
+
+/* updateHashIndex
+ * input: a pointer to a HashIndex, a TNode
+ * output: none
+ *
+ * Points the entry for node->data->key at node (used when the tree moves a Data* to a different TNode)
+ */
+void updateHashIndex( HashIndex* h, TNode* node )
+{
+    int i = findHashSlot( h, node->data->key, dataKeyHash( node->data ) );
+    if( i!=-1 )
+        h->entries[i].node = node;
+}
+
+/* removeHashIndex
+ * input: a pointer to a HashIndex, a key
+ * output: none
+ *
+ * Removes key from the index.  Later entries of the probe run are shifted back one slot so no tombstones are needed.
+ */
+void removeHashIndex( HashIndex* h, char* key )
+{
+    int mask = h->capacity-1;
+    int i = findHashSlot( h, key, hashKey( key ) );
+    int next;
+
+    if( i==-1 )
+        return;
+
+    next = (i+1) & mask;
+    while( h->entries[next].node!=NULL && h->entries[next].dist>0 ){
+        h->entries[i] = h->entries[next];
+        h->entries[i].dist--;
+        i = next;
+        next = (next+1) & mask;
+    }
+    h->entries[i].node = NULL;
+    h->size--;
+}
+
+/* findHashSlot
+ * input: a pointer to a HashIndex, a key, the hash of key
+ * output: the slot holding key or -1 if key is not indexed
+ *
+ * Robin Hood invariant: once we have probed further than the entry in the slot did, key can't be further on
+ */
+int findHashSlot( HashIndex* h, char* key, unsigned int hash )
+{
+    int mask = h->capacity-1;
+    int i = hash & mask;
+    unsigned int dist = 0;
+    HashEntry* e;
+
+    while( true ){
+        e = &h->entries[i];
+        if( e->node==NULL || e->dist < dist )
+            return -1;
+        if( e->hash==hash && ( e->node->data->key==key || strcmp( e->node->data->key, key )==0 ) )
+            return i;
+        i = (i+1) & mask;
+        dist++;
+    }
+}
+
+/* placeHashEntry
+ * input: a pointer to a HashIndex, an entry
+ * output: none
+ *
+ * Robin Hood insertion: the entry steals the slot of any entry that is closer to its home slot
+ */
+void placeHashEntry( HashIndex* h, HashEntry e )
+{
+    int mask = h->capacity-1;
+    int i = e.hash & mask;
+    HashEntry temp;
+
+    e.dist = 0;
+    while( h->entries[i].node!=NULL ){
+        if( h->entries[i].dist < e.dist ){
+            temp = h->entries[i];
+            h->entries[i] = e;
+            e = temp;
+        }
+        i = (i+1) & mask;
+        e.dist++;
+    }
+    h->entries[i] = e;
+}
+
+/* growHashIndex
+ * input: a pointer to a HashIndex
+ * output: none
+ *
+ * Doubles the number of slots and reinserts every entry
+ */
+void growHashIndex( HashIndex* h )
+{
+    HashEntry* old = h->entries;
+    int i, oldCapacity = h->capacity;
+
+    h->capacity *= 2;
+    h->entries = (HashEntry*)calloc( h->capacity, sizeof(HashEntry) );
+    for( i=0; i<oldCapacity; i++ ){
+        if( old[i].node!=NULL )
+            placeHashEntry( h, old[i] );
+    }
+    free( old );
+}
+
+/* memoryUsageHashIndex
+ * input: a pointer to a HashIndex
+ * output: the bytes used by the HashIndex and its table (empty slots count as overhead)
+ */
+MemoryUsage memoryUsageHashIndex( HashIndex* h )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = h->size;
+    addNodeMemory( &mu, h, sizeof(HashIndex) );
+    addArrayMemory( &mu, h->entries, h->size*sizeof(HashEntry), h->capacity*sizeof(HashEntry) );
+    return mu;
+}
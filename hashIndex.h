@@ -0,0 +1,38 @@
+#ifndef _hashIndex_h
+#define _hashIndex_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "tree.h"
+
+typedef struct HashEntry
+{
+    TNode* node;            /* the TNode holding the key (NULL for an empty slot) */
+    unsigned int hash;      /* hash of node->data->key, compared before the key itself */
+    unsigned int dist;      /* distance of this entry from its home slot (Robin Hood probe length) */
+}  HashEntry;
+
+typedef struct HashIndex
+{
+    HashEntry* entries;     /* open addressing table */
+    int capacity;           /* number of slots (always a power of 2) */
+    int size;               /* number of keys stored */
+}  HashIndex;
+
+/**********  Functions for creating/freeing a hash index **********/
+HashIndex* createHashIndex( );
+void freeHashIndex( HashIndex* h );
+
+/**********  Functions for using a hash index **********/
+TNode* searchHashIndex( HashIndex* h, Data* tData );
+void insertHashIndex( HashIndex* h, TNode* node );
+void updateHashIndex( HashIndex* h, TNode* node );
+void removeHashIndex( HashIndex* h, char* key );
+unsigned int hashKey( char* key );
+
+/**********  Functions for measuring the memory of a hash index **********/
+MemoryUsage memoryUsageHashIndex( HashIndex* h );
+
+#endif
@@ -0,0 +1,273 @@
+#include "intervalTree.h"
+#include "stats.h"
+
+/**********  Helper functions for an interval tree **********/
+void freeINodes( INode* root );
+int compareIntervals( Interval* a, Interval* b );
+INode* insertINode( INode* root, Interval iv );
+INode* removeINode( INode* root, Interval* iv, bool* removed );
+INode* removeMinINode( INode* root, INode** pMin );
+void updateINode( INode* x );
+INode* rebalanceINode( INode* x );
+INode* rightRotateINode( INode* oldRoot );
+INode* leftRotateINode( INode* oldRoot );
+int iNodeHeight( INode* x );
+void reportOverlaps( INode* x, double queryLow, double queryHigh, Interval* results, int maxResults, int* pCount );
+void addINodeMemory( INode* root, MemoryUsage* mu );
+
+/* createIntervalTree
+ * input: none
+ * output: a pointer to an IntervalTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Creates a new empty IntervalTree: an AVL tree of intervals ordered by their low end where every node also
+ * keeps the largest high end in its subtree, so whole subtrees that end before a query can be skipped.
+ */
+IntervalTree* createIntervalTree( )
+{
+    IntervalTree* it = (IntervalTree*)malloc( sizeof(IntervalTree) );
+    it->root = NULL;
+    it->size = 0;
+    return it;
+}
+
+/* freeIntervalTree
+ * input: a pointer to an IntervalTree
+ * output: none
+ *
+ * frees the given IntervalTree
+ */
+void freeIntervalTree( IntervalTree* it )
+{
+    freeINodes( it->root );
+    free( it );
+}
+
+void freeINodes( INode* root )
+{
+    if( root==NULL )
+        return;
+    freeINodes( root->pLeft );
+    freeINodes( root->pRight );
+    free( root );
+}
+
+/* insertInterval
+ * input: a pointer to an IntervalTree, an Interval
+ * output: none
+ *
+ * Stores iv in the tree in O(log n).  Equal intervals are stored once per insert as long as their ids differ.
+ */
+void insertInterval( IntervalTree* it, Interval iv )
+{
+    it->root = insertINode( it->root, iv );
+    it->size++;
+}
+
+/* removeInterval
+ * input: a pointer to an IntervalTree, an Interval
+ * output: true if an interval with the same low, high and id was found and removed
+ */
+bool removeInterval( IntervalTree* it, Interval iv )
+{
+    bool removed = false;
+    it->root = removeINode( it->root, &iv, &removed );
+    if( removed )
+        it->size--;
+    return removed;
+}
+
+/* stabIntervals and overlapIntervals
+ * input: a pointer to an IntervalTree, a query point (or the ends of a closed query range), an array for the
+ *        results and its capacity
+ * output: the number of stored intervals that contain queryPoint (or overlap the query range)
+ *
+ * Reports the matching intervals in order of their low end.  Only the first maxResults are written to results,
+ * but all of them are counted.  A subtree is only entered if its maxHigh reaches the query and its intervals
+ * can start before the query ends, so the cost is O(log n) per reported interval (O(log n) if there are none).
+ */
+int stabIntervals( IntervalTree* it, double queryPoint, Interval* results, int maxResults )
+{
+    return overlapIntervals( it, queryPoint, queryPoint, results, maxResults );
+}
+
+int overlapIntervals( IntervalTree* it, double queryLow, double queryHigh, Interval* results, int maxResults )
+{
+    int count = 0;
+    reportOverlaps( it->root, queryLow, queryHigh, results, maxResults, &count );
+    return count;
+}
+
+void reportOverlaps( INode* x, double queryLow, double queryHigh, Interval* results, int maxResults, int* pCount )
+{
+    while( x!=NULL && x->maxHigh >= queryLow ){
+        reportOverlaps( x->pLeft, queryLow, queryHigh, results, maxResults, pCount );
+
+        if( x->iv.low > queryHigh )
+            return; /* x and everything to its right start after the query */
+        if( x->iv.high >= queryLow ){
+            if( *pCount < maxResults )
+                results[*pCount] = x->iv;
+            (*pCount)++;
+        }
+        x = x->pRight;
+    }
+}
+
+/* compareIntervals
+ * input: two Interval pointers
+ * output: negative, zero or positive as a is ordered before, equal to or after b (by low, then high, then id)
+ */
+int compareIntervals( Interval* a, Interval* b )
+{
+    if( a->low != b->low )
+        return a->low < b->low ? -1 : 1;
+    if( a->high != b->high )
+        return a->high < b->high ? -1 : 1;
+    return (a->id > b->id) - (a->id < b->id); /* a->id - b->id could overflow */
+}
+
+INode* insertINode( INode* root, Interval iv )
+{
+    if( root==NULL ){
+        root = (INode*)malloc( sizeof(INode) );
+        STATS_INC( allocations );
+        root->pLeft = NULL;
+        root->pRight = NULL;
+        root->iv = iv;
+        updateINode( root );
+        return root;
+    }
+
+    if( compareIntervals( &iv, &root->iv ) < 0 )
+        root->pLeft = insertINode( root->pLeft, iv );
+    else
+        root->pRight = insertINode( root->pRight, iv );
+    return rebalanceINode( root );
+}
+
+INode* removeINode( INode* root, Interval* iv, bool* removed )
+{
+    int cmp;
+    INode *min;
+
+    if( root==NULL )
+        return NULL;
+
+    cmp = compareIntervals( iv, &root->iv );
+    if( cmp < 0 )
+        root->pLeft = removeINode( root->pLeft, iv, removed );
+    else if( cmp > 0 )
+        root->pRight = removeINode( root->pRight, iv, removed );
+    else{
+        *removed = true;
+        if( root->pLeft==NULL || root->pRight==NULL ){
+            min = root->pLeft!=NULL ? root->pLeft : root->pRight;
+            free( root );
+            return min;
+        }
+        /* two children: the next interval in order takes root's place */
+        root->pRight = removeMinINode( root->pRight, &min );
+        min->pLeft = root->pLeft;
+        min->pRight = root->pRight;
+        free( root );
+        root = min;
+    }
+    return rebalanceINode( root );
+}
+
+/* removeMinINode
+ * input: an INode, a pointer used to return the unlinked node
+ * output: the new root of the subtree without its first interval
+ */
+INode* removeMinINode( INode* root, INode** pMin )
+{
+    if( root->pLeft==NULL ){
+        *pMin = root;
+        return root->pRight;
+    }
+    root->pLeft = removeMinINode( root->pLeft, pMin );
+    return rebalanceINode( root );
+}
+
+/* updateINode
+ * input: an INode whose children are up to date
+ * output: none
+ *
+ * Recomputes the height and maxHigh of x
+ */
+void updateINode( INode* x )
+{
+    x->height = 1 + ( iNodeHeight( x->pLeft ) > iNodeHeight( x->pRight ) ? iNodeHeight( x->pLeft ) : iNodeHeight( x->pRight ) );
+    x->maxHigh = x->iv.high;
+    if( x->pLeft!=NULL && x->pLeft->maxHigh > x->maxHigh )
+        x->maxHigh = x->pLeft->maxHigh;
+    if( x->pRight!=NULL && x->pRight->maxHigh > x->maxHigh )
+        x->maxHigh = x->pRight->maxHigh;
+}
+
+INode* rebalanceINode( INode* x )
+{
+    int balance = iNodeHeight( x->pLeft ) - iNodeHeight( x->pRight );
+
+    if( balance > 1 ){
+        if( iNodeHeight( x->pLeft->pLeft ) < iNodeHeight( x->pLeft->pRight ) )
+            x->pLeft = leftRotateINode( x->pLeft );
+        return rightRotateINode( x );
+    }
+    if( balance < -1 ){
+        if( iNodeHeight( x->pRight->pRight ) < iNodeHeight( x->pRight->pLeft ) )
+            x->pRight = rightRotateINode( x->pRight );
+        return leftRotateINode( x );
+    }
+    updateINode( x );
+    return x;
+}
+
+INode* rightRotateINode( INode* oldRoot )
+{
+    INode* newRoot = oldRoot->pLeft;
+    oldRoot->pLeft = newRoot->pRight;
+    newRoot->pRight = oldRoot;
+    updateINode( oldRoot );
+    updateINode( newRoot );
+    return newRoot;
+}
+
+INode* leftRotateINode( INode* oldRoot )
+{
+    INode* newRoot = oldRoot->pRight;
+    oldRoot->pRight = newRoot->pLeft;
+    newRoot->pLeft = oldRoot;
+    updateINode( oldRoot );
+    updateINode( newRoot );
+    return newRoot;
+}
+
+int iNodeHeight( INode* x )
+{
+    return x==NULL ? 0 : x->height;
+}
+
+/* memoryUsageIntervalTree
+ * input: a pointer to an IntervalTree
+ * output: the bytes used by the IntervalTree and its INodes (one element per interval)
+ */
+MemoryUsage memoryUsageIntervalTree( IntervalTree* it )
+{
+    MemoryUsage mu;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = it->size;
+    addNodeMemory( &mu, it, sizeof(IntervalTree) );
+    addINodeMemory( it->root, &mu );
+    return mu;
+}
+
+void addINodeMemory( INode* root, MemoryUsage* mu )
+{
+    if( root==NULL )
+        return;
+    addNodeMemory( mu, root, sizeof(INode) );
+    addINodeMemory( root->pLeft, mu );
+    addINodeMemory( root->pRight, mu );
+}
@@ -0,0 +1,46 @@
+#ifndef _intervalTree_h
+#define _intervalTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "memoryUsage.h"
+
+typedef struct Interval
+{
+    double low, high;       /* the closed interval from low to high */
+    int id;                 /* caller supplied id used to tell equal intervals apart */
+}  Interval;
+
+typedef struct INode
+{
+    struct INode* pLeft;    /* left child (intervals ordered before iv) */
+    struct INode* pRight;   /* right child (intervals ordered after iv) */
+    int height;             /* max number of nodes on path from this node down to a leaf of the tree */
+    Interval iv;            /* the interval stored in this node, ordered by (low, high, id) */
+    double maxHigh;         /* largest high of any interval in the subtree */
+}  INode;
+
+typedef struct IntervalTree
+{
+    INode* root;            /* the root of this tree (it will be a NULL if the tree is empty) */
+    int size;               /* number of intervals stored */
+}  IntervalTree;
+
+/**********  Functions for creating/freeing an interval tree **********/
+IntervalTree* createIntervalTree( );
+void freeIntervalTree( IntervalTree* it );
+
+/**********  Functions for inserting/removing from an interval tree **********/
+void insertInterval( IntervalTree* it, Interval iv );
+bool removeInterval( IntervalTree* it, Interval iv );
+
+/**********  Functions for reporting from an interval tree **********/
+int stabIntervals( IntervalTree* it, double queryPoint, Interval* results, int maxResults );
+int overlapIntervals( IntervalTree* it, double queryLow, double queryHigh, Interval* results, int maxResults );
+
+/**********  Functions for measuring the memory of an interval tree **********/
+MemoryUsage memoryUsageIntervalTree( IntervalTree* it );
+
+#endif
@@ -0,0 +1,306 @@
+#include "keyIntern.h"
+
+/*
+ * Maximum load (in percent) of a KeyTable before it doubles
+ */
+int const KEY_TABLE_MAX_LOAD = 70;
+
+/**********  Helper functions for a key table **********/
+int findKeySlot( KeyTable* kt, char* key, unsigned int hash, int length );
+void growKeyTable( KeyTable* kt );
+char* copyToArena( KeyTable* kt, char* key, unsigned int hash, int length );
+InternedKey* internedKeyHeader( char* key );
+unsigned int hashString( char* key, int* pLength );
+
+/**********  Functions for creating/freeing a key table **********/
+
+/* createKeyTable
+ * input: none
+ * output: a pointer to a KeyTable (this is malloc-ed so must be freed eventually with freeKeyTable!)
+ *
+ * Creates a new empty KeyTable.  A KeyTable stores each distinct key once in an arena, together with its
+ * hash and length, so Data holding the same key can share one string and be compared by pointer.  The code
+ * that creates the table owns it: Data point into the arena only through internData (or by setting
+ * internedKey themselves), and the table must outlive them.
+ */
+KeyTable* createKeyTable( )
+{
+    KeyTable* kt = (KeyTable*)malloc( sizeof(KeyTable) );
+    kt->capacity = KEY_TABLE_MIN_CAPACITY;
+    kt->size = 0;
+    kt->slots = (KeySlot*)calloc( kt->capacity, sizeof(KeySlot) );
+    kt->chunks = NULL;
+    return kt;
+}
+
+/* freeKeyTable
+ * input: a pointer to a KeyTable
+ * output: none
+ *
+ * Frees the table and its arena.  Every Data pointing into the arena must be freed first.
+ */
+void freeKeyTable( KeyTable* kt )
+{
+    KeyArenaChunk* chunk;
+
+    while( kt->chunks!=NULL ){
+        chunk = kt->chunks;
+        kt->chunks = chunk->next;
+        free( chunk );
+    }
+    free( kt->slots );
+    free( kt );
+}
+
+
+/**********  Functions for interning keys **********/
+
+/* internKey
+ * input: a pointer to a KeyTable, a key
+ * output: the interned copy of key
+ *
+ * Returns the copy of key already in the table or adds one.  key itself is not kept and may be freed.  A
+ * Data given the result must have internedKey set (internData does both).
+ */
+char* internKey( KeyTable* kt, char* key )
+{
+    int length, i;
+    unsigned int hash;
+
+    hash = hashString( key, &length );
+    i = findKeySlot( kt, key, hash, length );
+    if( kt->slots[i].key!=NULL )
+        return kt->slots[i].key;
+
+    if( 100*(kt->size+1) > KEY_TABLE_MAX_LOAD*kt->capacity ){
+        growKeyTable( kt );
+        i = findKeySlot( kt, key, hash, length );
+    }
+    kt->slots[i].key = copyToArena( kt, key, hash, length );
+    kt->slots[i].hash = hash;
+    kt->size++;
+    return kt->slots[i].key;
+}
+
+/* findInternedKey
+ * input: a pointer to a KeyTable, a key
+ * output: the interned copy of key or NULL if the table does not hold key
+ *
+ * A NULL result means no Data interned in kt holds key, so a lookup can stop without searching a tree.
+ */
+char* findInternedKey( KeyTable* kt, char* key )
+{
+    int length;
+    unsigned int hash = hashString( key, &length );
+
+    return kt->slots[ findKeySlot( kt, key, hash, length ) ].key;
+}
+
+/* internData
+ * input: a pointer to a KeyTable, a Data*
+ * output: none
+ *
+ * Points d->key at its interned copy, freeing the malloc-ed key d held before, and marks d so freeData
+ * leaves the key to kt
+ */
+void internData( KeyTable* kt, Data* d )
+{
+    char* key = internKey( kt, d->key );
+
+    if( key!=d->key ){
+        if( !d->internedKey )
+            free( d->key );
+        d->key = key;
+    }
+    d->internedKey = true;
+}
+
+/* findKeySlot
+ * input: a pointer to a KeyTable, a key, its hash and length
+ * output: the slot holding key, or the empty slot where it would go
+ */
+int findKeySlot( KeyTable* kt, char* key, unsigned int hash, int length )
+{
+    int mask = kt->capacity-1;
+    int i = hash & mask;
+    KeySlot* s;
+
+    while( true ){
+        s = &kt->slots[i];
+        if( s->key==NULL )
+            return i;
+        if( s->hash==hash && internedKeyHeader( s->key )->length==length && memcmp( s->key, key, length )==0 )
+            return i;
+        i = (i+1) & mask;
+    }
+}
+
+/* growKeyTable
+ * input: a pointer to a KeyTable
+ * output: none
+ *
+ * Doubles the number of slots.  The keys stay where they are in the arena.
+ */
+void growKeyTable( KeyTable* kt )
+{
+    KeySlot* old = kt->slots;
+    int oldCapacity = kt->capacity;
+    int i, j, mask;
+
+    kt->capacity *= 2;
+    kt->slots = (KeySlot*)calloc( kt->capacity, sizeof(KeySlot) );
+    mask = kt->capacity-1;
+    for( i=0; i<oldCapacity; i++ ){
+        if( old[i].key==NULL )
+            continue;
+        j = old[i].hash & mask;
+        while( kt->slots[j].key!=NULL )
+            j = (j+1) & mask;
+        kt->slots[j] = old[i];
+    }
+    free( old );
+}
+
+/* copyToArena
+ * input: a pointer to a KeyTable, a key, its hash and length
+ * output: the copy of key in the arena
+ *
+ * Appends an InternedKey to the newest chunk, starting a new chunk (twice the size of the last one) when
+ * it is full.  Records are padded so the hash and length in front of every key stay aligned.
+ */
+char* copyToArena( KeyTable* kt, char* key, unsigned int hash, int length )
+{
+    size_t header = offsetof( InternedKey, str );
+    size_t bytes = (header + length + 1 + header-1) / header * header;
+    size_t size;
+    KeyArenaChunk* chunk = kt->chunks;
+    InternedKey* ik;
+
+    if( chunk==NULL || chunk->used+bytes > chunk->size ){
+        size = chunk==NULL ? KEY_ARENA_MIN_CHUNK_BYTES : 2*chunk->size;
+        if( size > KEY_ARENA_MAX_CHUNK_BYTES )
+            size = KEY_ARENA_MAX_CHUNK_BYTES;
+        if( size < bytes )
+            size = bytes;
+        chunk = (KeyArenaChunk*)malloc( sizeof(KeyArenaChunk) + size );
+        chunk->next = kt->chunks;
+        chunk->size = size;
+        chunk->used = 0;
+        kt->chunks = chunk;
+    }
+
+    ik = (InternedKey*)(chunk->bytes + chunk->used);
+    ik->hash = hash;
+    ik->length = length;
+    memcpy( ik->str, key, length+1 );
+    chunk->used += bytes;
+    return ik->str;
+}
+
+
+/**********  Functions for using interned keys **********/
+
+/* internedKeyHeader
+ * input: an interned key
+ * output: the InternedKey holding it
+ */
+InternedKey* internedKeyHeader( char* key )
+{
+    return (InternedKey*)(key - offsetof( InternedKey, str ));
+}
+
+/* keyHash
+ * input: a key
+ * output: the 32-bit FNV-1a hash of the key
+ */
+unsigned int keyHash( char* key )
+{
+    int length;
+
+    return hashString( key, &length );
+}
+
+/* dataKeyHash
+ * input: a Data*
+ * output: keyHash of d->key
+ *
+ * An interned key returns the hash stored in front of it without reading the string
+ */
+unsigned int dataKeyHash( Data* d )
+{
+    if( d->internedKey )
+        return internedKeyHeader( d->key )->hash;
+    return keyHash( d->key );
+}
+
+/* dataKeyLength
+ * input: a Data*
+ * output: strlen of d->key (stored in front of an interned key)
+ */
+int dataKeyLength( Data* d )
+{
+    if( d->internedKey )
+        return internedKeyHeader( d->key )->length;
+    return strlen( d->key );
+}
+
+/* hashString
+ * input: a string, a pointer to an int
+ * output: the 32-bit FNV-1a hash of the string, its length is stored in *pLength
+ */
+unsigned int hashString( char* key, int* pLength )
+{
+    unsigned int hash = 2166136261u;
+    char* p = key;
+
+    while( *p!='\0' ){
+        hash ^= (unsigned char)*p++;
+        hash *= 16777619u;
+    }
+    *pLength = p-key;
+    return hash;
+}
+
+
+/**********  Functions for measuring the memory of keys **********/
+
+/* addKeyMemory
+ * input: a MemoryUsage, a Data*
+ * output: none
+ *
+ * Counts a malloc-ed key as payload.  Interned keys are shared, so they are counted once by
+ * memoryUsageKeyTable instead.
+ */
+void addKeyMemory( MemoryUsage* mu, Data* d )
+{
+    if( d->key!=NULL && !d->internedKey )
+        addStringMemory( mu, d->key );
+}
+
+/* memoryUsageKeyTable
+ * input: a pointer to a KeyTable
+ * output: the bytes used by the table, its slots and its arena
+ *
+ * The keys are payload, their hash/length headers and padding are node bytes and the unused end of every
+ * chunk is overhead.
+ */
+MemoryUsage memoryUsageKeyTable( KeyTable* kt )
+{
+    MemoryUsage mu;
+    KeyArenaChunk* chunk;
+    int i;
+    size_t keyBytes = 0;
+
+    resetMemoryUsage( &mu );
+    mu.numElements = kt->size;
+    addNodeMemory( &mu, kt, sizeof(KeyTable) );
+    addArrayMemory( &mu, kt->slots, kt->size*sizeof(KeySlot), kt->capacity*sizeof(KeySlot) );
+    for( i=0; i<kt->capacity; i++ )
+        if( kt->slots[i].key!=NULL )
+            keyBytes += internedKeyHeader( kt->slots[i].key )->length+1;
+    for( chunk=kt->chunks; chunk!=NULL; chunk=chunk->next )
+        addArrayMemory( &mu, chunk, sizeof(KeyArenaChunk) + chunk->used, sizeof(KeyArenaChunk) + chunk->size );
+    mu.nodeBytes -= keyBytes;
+    mu.payloadBytes += keyBytes;
+    return mu;
+}
@@ -0,0 +1,67 @@
+#ifndef _keyIntern_h
+#define _keyIntern_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "data.h"
+#include "memoryUsage.h"
+
+#define KEY_TABLE_MIN_CAPACITY 1024         /* initial number of slots (always a power of 2) */
+#define KEY_ARENA_MIN_CHUNK_BYTES (1<<16)   /* size of the first arena chunk, each new chunk is twice as big... */
+#define KEY_ARENA_MAX_CHUNK_BYTES (1<<24)   /* ...up to this size */
+
+/*
+ * An interned key as it is laid out in the arena.  Data->key points at str, so the hash and the length
+ * are found just in front of the string.  A Data holding an interned key has internedKey set.
+ */
+typedef struct InternedKey
+{
+    unsigned int hash;      /* hashKey of str */
+    unsigned int length;    /* strlen of str */
+    char str[];             /* the key, '\0' terminated */
+}  InternedKey;
+
+typedef struct KeyArenaChunk
+{
+    struct KeyArenaChunk* next; /* the previous (smaller) chunk of the same table */
+    size_t size;                /* bytes available in bytes[] */
+    size_t used;                /* bytes of bytes[] holding InternedKeys */
+    char bytes[];
+}  KeyArenaChunk;
+
+typedef struct KeySlot
+{
+    char* key;              /* the interned key (NULL for an empty slot) */
+    unsigned int hash;      /* its hash, compared before the key itself */
+}  KeySlot;
+
+typedef struct KeyTable
+{
+    KeySlot* slots;         /* open addressing table over the distinct keys */
+    int capacity;           /* number of slots (always a power of 2) */
+    int size;               /* number of distinct keys stored */
+    KeyArenaChunk* chunks;  /* the arena holding the keys, newest (largest) chunk first */
+}  KeyTable;
+
+/**********  Functions for creating/freeing a key table **********/
+KeyTable* createKeyTable( );
+void freeKeyTable( KeyTable* kt );
+
+/**********  Functions for interning keys **********/
+char* internKey( KeyTable* kt, char* key );
+char* findInternedKey( KeyTable* kt, char* key );
+void internData( KeyTable* kt, Data* d );
+
+/**********  Functions for using interned keys **********/
+unsigned int keyHash( char* key );
+unsigned int dataKeyHash( Data* d );
+int dataKeyLength( Data* d );
+
+/**********  Functions for measuring the memory of keys **********/
+void addKeyMemory( MemoryUsage* mu, Data* d );
+MemoryUsage memoryUsageKeyTable( KeyTable* kt );
+
+#endif
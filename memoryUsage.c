@@ -0,0 +1,133 @@
+#include "memoryUsage.h"
+
+/* stdlib.h (from memoryUsage.h) defines __GLIBC__ on glibc systems */
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/**********  Functions for counting memory **********/
+
+/* resetMemoryUsage
+ * input: a MemoryUsage
+ * output: none
+ *
+ * Zeroes every count
+ */
+void resetMemoryUsage( MemoryUsage* mu )
+{
+    memset( mu, 0, sizeof(MemoryUsage) );
+}
+
+/* addNodeMemory and addPayloadMemory
+ * input: a MemoryUsage, a malloc-ed block (NULL is ignored), the bytes of the block in use
+ * output: none
+ *
+ * Counts the bytes in use as node or payload bytes and the rest of the block as overhead
+ */
+void addNodeMemory( MemoryUsage* mu, void* block, size_t bytes )
+{
+    if( block==NULL )
+        return;
+    mu->numAllocations++;
+    mu->nodeBytes += bytes;
+    mu->overheadBytes += allocatedBytes( block, bytes ) - bytes;
+}
+
+void addPayloadMemory( MemoryUsage* mu, void* block, size_t bytes )
+{
+    if( block==NULL )
+        return;
+    mu->numAllocations++;
+    mu->payloadBytes += bytes;
+    mu->overheadBytes += allocatedBytes( block, bytes ) - bytes;
+}
+
+/* addArrayMemory
+ * input: a MemoryUsage, a malloc-ed array (NULL is ignored), the bytes of its used entries, the bytes it was
+ *        allocated with
+ * output: none
+ *
+ * Counts the used entries as node bytes.  The unused capacity (capacityBytes-usedBytes) counts as overhead,
+ * on top of what the allocator adds to a block of capacityBytes.
+ */
+void addArrayMemory( MemoryUsage* mu, void* block, size_t usedBytes, size_t capacityBytes )
+{
+    if( block==NULL )
+        return;
+    addNodeMemory( mu, block, capacityBytes );
+    mu->nodeBytes -= capacityBytes - usedBytes;
+    mu->overheadBytes += capacityBytes - usedBytes;
+}
+
+/* addStringMemory
+ * input: a MemoryUsage, a malloc-ed string (NULL is ignored)
+ * output: none
+ *
+ * Counts strlen+1 bytes as payload.  The unused tail of a fixed size buffer (e.g. the 31 bytes allocated
+ * for every key) shows up as overhead.
+ */
+void addStringMemory( MemoryUsage* mu, char* str )
+{
+    if( str!=NULL )
+        addPayloadMemory( mu, str, strlen( str )+1 );
+}
+
+/* addMemoryUsage
+ * input: two MemoryUsages
+ * output: none
+ *
+ * Adds mu to total
+ */
+void addMemoryUsage( MemoryUsage* total, MemoryUsage* mu )
+{
+    total->numElements += mu->numElements;
+    total->numAllocations += mu->numAllocations;
+    total->nodeBytes += mu->nodeBytes;
+    total->payloadBytes += mu->payloadBytes;
+    total->overheadBytes += mu->overheadBytes;
+}
+
+/* allocatedBytes
+ * input: a malloc-ed block, the number of bytes that were requested for it
+ * output: the bytes the block really takes from the heap (never less than bytes)
+ *
+ * glibc reports the usable size of the block, so only its header is added.  Elsewhere a typical allocator is
+ * assumed: one header word, 16 byte alignment and 32 byte minimum blocks.
+ */
+size_t allocatedBytes( void* block, size_t bytes )
+{
+    size_t size;
+
+#ifdef __GLIBC__
+    size = malloc_usable_size( block ) + MALLOC_HEADER_BYTES;
+#else
+    size = (bytes + MALLOC_HEADER_BYTES + 15) & ~(size_t)15;
+    if( size < 32 )
+        size = 32;
+#endif
+    return size < bytes ? bytes : size;
+}
+
+/**********  Functions for reporting memory **********/
+
+/* totalMemoryUsage
+ * input: a MemoryUsage
+ * output: every byte the structure takes from the heap
+ */
+size_t totalMemoryUsage( MemoryUsage* mu )
+{
+    return mu->nodeBytes + mu->payloadBytes + mu->overheadBytes;
+}
+
+/* printMemoryUsage
+ * input: a file, a name for the structure, a MemoryUsage
+ * output: none
+ *
+ * Prints one line with the byte counts and the bytes per element
+ */
+void printMemoryUsage( FILE* out, char* name, MemoryUsage* mu )
+{
+    fprintf( out, "%s memory (in bytes): %lu total = %lu node + %lu payload + %lu overhead, %ld allocations, %.1lf bytes/element\n",
+        name, (unsigned long)totalMemoryUsage( mu ), (unsigned long)mu->nodeBytes, (unsigned long)mu->payloadBytes,
+        (unsigned long)mu->overheadBytes, mu->numAllocations, mu->numElements==0 ? 0.0 : (double)totalMemoryUsage( mu )/mu->numElements );
+}
@@ -0,0 +1,33 @@
+#ifndef _memoryUsage_h
+#define _memoryUsage_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* bytes the allocator keeps in front of every block (glibc's chunk size word) */
+#define MALLOC_HEADER_BYTES sizeof(size_t)
+
+typedef struct MemoryUsage
+{
+    long numElements;       /* keys, nodes or slots held by the structure */
+    long numAllocations;    /* separate malloc-ed blocks counted below */
+    size_t nodeBytes;       /* bytes used by the structure itself: its header, nodes and arrays */
+    size_t payloadBytes;    /* bytes used by what the nodes point to: Data, keys and Huffman str buffers */
+    size_t overheadBytes;   /* malloc headers, rounding and unused capacity of every block */
+}  MemoryUsage;
+
+/**********  Functions for counting memory **********/
+void resetMemoryUsage( MemoryUsage* mu );
+void addNodeMemory( MemoryUsage* mu, void* block, size_t bytes );
+void addPayloadMemory( MemoryUsage* mu, void* block, size_t bytes );
+void addArrayMemory( MemoryUsage* mu, void* block, size_t usedBytes, size_t capacityBytes );
+void addStringMemory( MemoryUsage* mu, char* str );
+void addMemoryUsage( MemoryUsage* total, MemoryUsage* mu );
+size_t allocatedBytes( void* block, size_t bytes );
+
+/**********  Functions for reporting memory **********/
+size_t totalMemoryUsage( MemoryUsage* mu );
+void printMemoryUsage( FILE* out, char* name, MemoryUsage* mu );
+
+#endif
@@ -0,0 +1,434 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "moveFile.h"
+
+/**********  Helper types for parsing a text file in parallel **********/
+typedef struct ParseTask
+{
+    const char* begin;      /* every token that starts in [begin,end) belongs to this task */
+    const char* end;
+    const char* fileEnd;    /* a token may run past end up to the end of the file */
+    double* values;         /* the doubles parsed by this task */
+    int count;              /* number of doubles parsed */
+    int capacity;           /* capacity of values */
+    bool isFixed;           /* true if values is the result array itself, which must not grow */
+    bool isFirst;           /* true for the range starting the move list, whose first token is never a tail */
+}  ParseTask;
+
+/**********  Helper functions for loading a move file **********/
+void loadTextMoves( MoveFile* mf, const char* text, size_t size, int numThreads );
+void loadBinaryMoves( MoveFile* mf, const char* bytes, size_t size );
+void* parseTextTask( void* arg );
+bool isMoveSpace( char c );
+const char* skipSpace( const char* p, const char* end );
+const char* parseLong( const char* p, const char* end, long* pValue );
+const char* parseDouble( const char* p, const char* end, double* pValue );
+
+/* powers of ten that are exact as doubles, used by the fast path of parseDouble */
+static const double exactPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/* loadMoveFile
+ * input: the name of a move file, the number of threads to parse a text file with
+ * output: a pointer to a MoveFile (this is malloc-ed so must be freed eventually with freeMoveFile!)
+ *
+ * Maps the whole file instead of reading it with fscanf.  A file that starts with MOVE_FILE_MAGIC is binary:
+ * the little-endian header is followed by numMoves little-endian doubles, which are used in place on a
+ * little-endian host.  Anything else is the text format (number of moves, the solution, then the moves),
+ * which is split into numThreads byte ranges that are parsed at the same time.
+ */
+MoveFile* loadMoveFile( char* fileName, int numThreads )
+{
+    MoveFile* mf;
+    struct stat st;
+    int fd = open( fileName, O_RDONLY );
+
+    if( fd<0 ){
+        printf("File %s not found.\n", fileName);
+        exit(-1);
+    }
+    if( fstat( fd, &st )!=0 || st.st_size==0 ){
+        printf( "Invalid file format.  First line should be number of moves followed by the correct solution (or -1 if none is provided)\n");
+        exit(-1);
+    }
+
+    mf = (MoveFile*)malloc( sizeof(MoveFile) );
+    mf->mappingSize = st.st_size;
+    mf->mapping = mmap( NULL, mf->mappingSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( mf->mapping==MAP_FAILED ){
+        printf("File %s could not be mapped.\n", fileName);
+        exit(-1);
+    }
+
+    if( mf->mappingSize>=MOVE_FILE_HEADER_SIZE && memcmp( mf->mapping, MOVE_FILE_MAGIC, 8 )==0 )
+        loadBinaryMoves( mf, (const char*)mf->mapping, mf->mappingSize );
+    else{
+        madvise( mf->mapping, mf->mappingSize, MADV_SEQUENTIAL );
+        loadTextMoves( mf, (const char*)mf->mapping, mf->mappingSize, numThreads );
+        /* the text is not needed once it is parsed */
+        munmap( mf->mapping, mf->mappingSize );
+        mf->mapping = NULL;
+    }
+
+    return mf;
+}
+
+/* freeMoveFile
+ * input: a pointer to a MoveFile
+ * output: none
+ *
+ * frees the moves (or unmaps them for a zero-copy binary file) and the MoveFile
+ */
+void freeMoveFile( MoveFile* mf )
+{
+    if( mf->ownsMoves )
+        free( mf->moves );
+    if( mf->mapping!=NULL )
+        munmap( mf->mapping, mf->mappingSize );
+    free( mf );
+}
+
+/* writeMoveFileBinary
+ * input: the name of the file to write, the moves, the number of moves, the provided solution
+ * output: none
+ *
+ * Writes the moves in the binary format read by loadMoveFile (little-endian whatever the host is)
+ */
+void writeMoveFileBinary( char* fileName, double* moves, int numMoves, int providedSolution )
+{
+    char header[MOVE_FILE_HEADER_SIZE];
+    char bytes[8];
+    uint64_t bits;
+    int i;
+    FILE* out = fopen( fileName, "wb" );
+
+    if( out==NULL ){
+        printf("File %s could not be created.\n", fileName);
+        exit(-1);
+    }
+
+    memcpy( header, MOVE_FILE_MAGIC, 8 );
+    writeLittleEndian64( header+8, (uint64_t)(int64_t)numMoves );
+    writeLittleEndian64( header+16, (uint64_t)(int64_t)providedSolution );
+    fwrite( header, 1, MOVE_FILE_HEADER_SIZE, out );
+
+    if( isLittleEndian( ) )
+        fwrite( moves, sizeof(double), numMoves, out );
+    else{
+        for( i=0; i<numMoves; i++ ){
+            memcpy( &bits, &moves[i], 8 );
+            writeLittleEndian64( bytes, bits );
+            fwrite( bytes, 1, 8, out );
+        }
+    }
+    fclose( out );
+}
+
+/* loadBinaryMoves
+ * input: a MoveFile, the mapped bytes, the size of the mapping
+ * output: none
+ */
+void loadBinaryMoves( MoveFile* mf, const char* bytes, size_t size )
+{
+    int64_t numMoves = (int64_t)readLittleEndian64( bytes+8 );
+    uint64_t bits;
+    int i;
+
+    if( numMoves<0 || numMoves>INT32_MAX || (size - MOVE_FILE_HEADER_SIZE)/8 < (uint64_t)numMoves ){
+        printf( "Invalid binary move file.  The header does not match the size of the file.\n");
+        exit(-1);
+    }
+    mf->numMoves = (int)numMoves;
+    mf->providedSolution = (int)(int64_t)readLittleEndian64( bytes+16 );
+
+    if( isLittleEndian( ) ){
+        /* zero-copy: the mapping is page aligned and the header keeps the doubles 8-byte aligned */
+        mf->moves = (double*)(bytes + MOVE_FILE_HEADER_SIZE);
+        mf->ownsMoves = false;
+        return;
+    }
+
+    mf->moves = (double*)malloc( mf->numMoves*sizeof(double) );
+    mf->ownsMoves = true;
+    for( i=0; i<mf->numMoves; i++ ){
+        bits = readLittleEndian64( bytes + MOVE_FILE_HEADER_SIZE + 8*(size_t)i );
+        memcpy( &mf->moves[i], &bits, 8 );
+    }
+}
+
+/* loadTextMoves
+ * input: a MoveFile, the mapped text, the size of the text, the number of threads
+ * output: none
+ *
+ * Reads the two header ints, splits the rest of the text into numThreads byte ranges and parses them in
+ * parallel.  Each range keeps the tokens that start in it, so a number is never cut in half.
+ */
+void loadTextMoves( MoveFile* mf, const char* text, size_t size, int numThreads )
+{
+    const char* fileEnd = text + size;
+    const char* p = text;
+    const char* body;
+    ParseTask* tasks;
+    pthread_t* threads;
+    bool* started;
+    long numMoves, providedSolution;
+    size_t bodySize;
+    int t, numCopied, total = 0;
+
+    p = parseLong( skipSpace( p, fileEnd ), fileEnd, &numMoves );
+    if( p!=NULL )
+        p = parseLong( skipSpace( p, fileEnd ), fileEnd, &providedSolution );
+    if( p==NULL ){
+        printf( "Invalid file format.  First line should be number of moves followed by the correct solution (or -1 if none is provided)\n");
+        exit(-1);
+    }
+    if( numMoves < 0 )
+    {
+        printf( "The number moves must be non-negative.\n");
+        exit(-1);
+    }
+    if( numMoves > INT32_MAX )
+    {
+        printf( "The number of moves does not fit in an int.\n");
+        exit(-1);
+    }
+    mf->numMoves = (int)numMoves;
+    mf->providedSolution = (int)providedSolution;
+    mf->moves = (double*)malloc( mf->numMoves*sizeof(double) );
+    mf->ownsMoves = true;
+
+    body = skipSpace( p, fileEnd );
+    bodySize = fileEnd - body;
+    if( numThreads < 1 )
+        numThreads = 1;
+    /* not worth a thread for less than a megabyte */
+    if( (size_t)numThreads > bodySize/(1<<20) + 1 )
+        numThreads = bodySize/(1<<20) + 1;
+
+    tasks = (ParseTask*)malloc( numThreads*sizeof(ParseTask) );
+    threads = (pthread_t*)malloc( numThreads*sizeof(pthread_t) );
+    started = (bool*)malloc( numThreads*sizeof(bool) );
+    for( t=0; t<numThreads; t++ ){
+        tasks[t].isFirst = t==0;
+        tasks[t].begin = body + bodySize*t/numThreads;
+        tasks[t].end = body + bodySize*(t+1)/numThreads;
+        tasks[t].fileEnd = fileEnd;
+        /* a single range writes straight into the result, several ranges get their own arrays */
+        tasks[t].isFixed = numThreads==1;
+        tasks[t].values = tasks[t].isFixed ? mf->moves : NULL;
+        tasks[t].capacity = tasks[t].isFixed ? mf->numMoves : 0;
+        tasks[t].count = 0;
+    }
+    /* a range runs here if no thread can be started for it */
+    for( t=1; t<numThreads; t++ ){
+        started[t] = pthread_create( &threads[t], NULL, parseTextTask, &tasks[t] )==0;
+        if( !started[t] )
+            parseTextTask( &tasks[t] );
+    }
+    parseTextTask( &tasks[0] );
+    for( t=1; t<numThreads; t++ )
+        if( started[t] )
+            pthread_join( threads[t], NULL );
+
+    for( t=0; t<numThreads; t++ ){
+        if( !tasks[t].isFixed ){
+            numCopied = tasks[t].count < mf->numMoves-total ? tasks[t].count : mf->numMoves-total;
+            if( numCopied>0 )
+                memcpy( &mf->moves[total], tasks[t].values, numCopied*sizeof(double) );
+            free( tasks[t].values );
+        }
+        total += tasks[t].count;
+    }
+    free( tasks );
+    free( threads );
+    free( started );
+
+    if( total < mf->numMoves ){
+        printf( "Failed to read %dth double in the move sequence", total );
+        exit(-1);
+    }
+}
+
+void* parseTextTask( void* arg )
+{
+    ParseTask* task = (ParseTask*)arg;
+    const char* p = task->begin;
+    double value;
+
+    /* skip the tail of a token that started in the previous range (before the first range is the header) */
+    if( !task->isFirst && p!=task->end && !isMoveSpace( p[-1] ) )
+        while( p < task->fileEnd && !isMoveSpace( *p ) )
+            p++;
+
+    for( p = skipSpace( p, task->fileEnd ); p < task->end; p = skipSpace( p, task->fileEnd ) ){
+        p = parseDouble( p, task->fileEnd, &value );
+        if( p==NULL ){
+            printf( "Failed to read %dth double in the move sequence", task->count );
+            exit(-1);
+        }
+        if( task->count==task->capacity ){
+            if( task->isFixed )
+                break; /* numbers past numMoves are ignored, as fscanf did */
+            task->capacity = task->capacity==0 ? 1024 : 2*task->capacity;
+            task->values = (double*)realloc( task->values, task->capacity*sizeof(double) );
+        }
+        task->values[task->count++] = value;
+    }
+    return NULL;
+}
+
+bool isMoveSpace( char c )
+{
+    return c==' ' || c=='\n' || c=='\r' || c=='\t' || c=='\v' || c=='\f';
+}
+
+const char* skipSpace( const char* p, const char* end )
+{
+    while( p < end && isMoveSpace( *p ) )
+        p++;
+    return p;
+}
+
+/* parseLong
+ * input: the start of a token, the end of the text, a pointer for the result
+ * output: a pointer just past the number (NULL if there is no number)
+ */
+const char* parseLong( const char* p, const char* end, long* pValue )
+{
+    bool negative = false;
+    long value = 0;
+    const char* digits;
+
+    if( p < end && (*p=='-' || *p=='+') )
+        negative = *p++=='-';
+    for( digits = p; p < end && *p>='0' && *p<='9'; p++ )
+        value = 10*value + (*p - '0');
+    if( p==digits )
+        return NULL;
+
+    *pValue = negative ? -value : value;
+    return p;
+}
+
+/* parseDouble
+ * input: the start of a token, the end of the text, a pointer for the result
+ * output: a pointer just past the number (NULL if there is no number)
+ *
+ * Collects up to 19 significant digits and the decimal exponent.  When the digits fit in 53 bits and the
+ * exponent is within 10^22 both are exact doubles, so one multiply/divide gives the correctly rounded value
+ * (the same one strtod/fscanf give).  Anything else (more digits, huge exponents, inf/nan) goes to strtod.
+ */
+const char* parseDouble( const char* p, const char* end, double* pValue )
+{
+    const char* start = p;
+    const char* tokenEnd;
+    char buffer[128];
+    char* parsedEnd;
+    bool negative = false, exponentNegative = false, sawDigit = false, isExact = true;
+    uint64_t mantissa = 0;
+    int numDigits = 0, exp10 = 0, exponent = 0;
+    size_t length;
+
+    if( p < end && (*p=='-' || *p=='+') )
+        negative = *p++=='-';
+    for( ; p < end && *p>='0' && *p<='9'; p++ ){
+        sawDigit = true;
+        if( mantissa==0 && *p=='0' )
+            continue; /* leading zeros */
+        if( numDigits<19 ){
+            mantissa = 10*mantissa + (*p - '0');
+            numDigits++;
+        }
+        else{
+            exp10++;
+            isExact = isExact && *p=='0';
+        }
+    }
+    if( p < end && *p=='.' ){
+        for( p++; p < end && *p>='0' && *p<='9'; p++ ){
+            sawDigit = true;
+            if( mantissa==0 && *p=='0' ){
+                exp10--;
+                continue;
+            }
+            if( numDigits<19 ){
+                mantissa = 10*mantissa + (*p - '0');
+                numDigits++;
+                exp10--;
+            }
+            else
+                isExact = isExact && *p=='0';
+        }
+    }
+    if( sawDigit && p < end && (*p=='e' || *p=='E') ){
+        p++;
+        if( p < end && (*p=='-' || *p=='+') )
+            exponentNegative = *p++=='-';
+        if( p==end || *p<'0' || *p>'9' )
+            isExact = false;
+        for( ; p < end && *p>='0' && *p<='9'; p++ ){
+            if( exponent<100000 )
+                exponent = 10*exponent + (*p - '0');
+        }
+        exp10 += exponentNegative ? -exponent : exponent;
+    }
+
+    if( sawDigit && isExact && (p==end || isMoveSpace( *p )) ){
+        if( mantissa==0 ){
+            *pValue = negative ? -0.0 : 0.0;
+            return p;
+        }
+        if( mantissa <= (1ULL<<53) && exp10>=-22 && exp10<=22 ){
+            *pValue = exp10<0 ? (double)mantissa / exactPowersOf10[-exp10] : (double)mantissa * exactPowersOf10[exp10];
+            if( negative )
+                *pValue = -*pValue;
+            return p;
+        }
+    }
+
+    /* slow path: hand the token to strtod */
+    for( tokenEnd = start; tokenEnd < end && !isMoveSpace( *tokenEnd ); tokenEnd++ );
+    length = tokenEnd - start;
+    if( length==0 || length>=sizeof(buffer) )
+        return NULL;
+    memcpy( buffer, start, length );
+    buffer[length] = '\0';
+    *pValue = strtod( buffer, &parsedEnd );
+    if( parsedEnd==buffer )
+        return NULL;
+    return start + (parsedEnd - buffer);
+}
+
+/* isLittleEndian, readLittleEndian64 and writeLittleEndian64
+ * input: none / 8 bytes / 8 bytes and a value
+ * output: whether the host is little-endian / the value stored in the bytes / none
+ *
+ * The binary files (move files and tree snapshots) are little-endian whatever the host is
+ */
+bool isLittleEndian( )
+{
+    uint16_t one = 1;
+    return *(char*)&one==1;
+}
+
+uint64_t readLittleEndian64( const char* bytes )
+{
+    uint64_t value = 0;
+    int i;
+    for( i=7; i>=0; i-- )
+        value = (value<<8) | (unsigned char)bytes[i];
+    return value;
+}
+
+void writeLittleEndian64( char* bytes, uint64_t value )
+{
+    int i;
+    for( i=0; i<8; i++ ){
+        bytes[i] = (char)(value & 0xff);
+        value >>= 8;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef _moveFile_h
+#define _moveFile_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define MOVE_FILE_MAGIC "CTPMOVES"   /* first 8 bytes of a binary move file */
+#define MOVE_FILE_HEADER_SIZE 24     /* magic, int64 number of moves, int64 provided solution (keeps the doubles 8-byte aligned) */
+
+typedef struct MoveFile
+{
+    double* moves;          /* the move sequence (points into the mapping for a binary file read zero-copy) */
+    int numMoves;           /* number of moves */
+    int providedSolution;   /* the solution given in the file (-1 if none is provided) */
+    void* mapping;          /* the mmap-ed file (NULL once released) */
+    size_t mappingSize;     /* size of the mapping in bytes */
+    bool ownsMoves;         /* true if moves was malloc-ed (text files, or binary files on a big-endian host) */
+}  MoveFile;
+
+/**********  Functions for loading/freeing a move file **********/
+MoveFile* loadMoveFile( char* fileName, int numThreads );
+void freeMoveFile( MoveFile* mf );
+
+/**********  Functions for writing a move file **********/
+void writeMoveFileBinary( char* fileName, double* moves, int numMoves, int providedSolution );
+
+/**********  Functions for reading/writing little-endian values **********/
+bool isLittleEndian( );
+uint64_t readLittleEndian64( const char* bytes );
+void writeLittleEndian64( char* bytes, uint64_t value );
+
+#endif
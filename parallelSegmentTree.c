@@ -0,0 +1,295 @@
+#include "parallelSegmentTree.h"
+#include "stats.h"
+
+/**********  Helper types for building a segment tree in parallel **********/
+typedef struct BuildTask
+{
+    double* points;         /* the sorted unique points */
+    int low, high;          /* the sub-array to build a tree for */
+    int forkDepth;          /* number of further levels that may still hand half of the work to a new thread */
+    TNode* root;            /* the built subtree */
+}  BuildTask;
+
+/**********  Helper types for inserting segments in parallel **********/
+typedef struct SegmentBucket
+{
+    int* segments;          /* indices of the segments that reach a frontier TNode */
+    int size;               /* number of indices stored */
+    int capacity;           /* current capacity of segments */
+}  SegmentBucket;
+
+typedef struct InsertBatch
+{
+    TNode** nodes;          /* TNodes of the top of the tree in heap order (children of i are 2i+1 and 2i+2) */
+    bool* isFrontier;       /* true for TNodes where the top ends and a thread owns the whole subtree */
+    int numSlots;           /* number of entries in nodes/isFrontier */
+    double* segmentStart;   /* the segments being inserted */
+    double* segmentEnd;
+    int numThreads;
+}  InsertBatch;
+
+typedef struct InsertTask
+{
+    InsertBatch* batch;     /* shared, read-only description of the top of the tree */
+    int thread;             /* index of this thread */
+    int first, last;        /* phase 1: range of segments this thread routes through the top of the tree */
+    int* topCnt;            /* phase 1: this thread's cnt increments for TNodes in the top of the tree */
+    SegmentBucket* buckets; /* phase 1: this thread's segments reaching each frontier TNode */
+    struct InsertTask* allTasks; /* phase 2: every thread's buckets */
+}  InsertTask;
+
+/**********  Helper functions for parallel construction/insertion **********/
+void* buildSegmentTreeTask( void* arg );
+int forkDepthFor( int numThreads );
+void collectTopNodes( InsertBatch* batch, TNode* x, int i, int depth, int frontierDepth );
+void routeSegment( InsertTask* task, int i, int segment );
+void* routeSegmentsTask( void* arg );
+void* insertFrontierTask( void* arg );
+
+/* constructSegmentTreeParallel
+ * input: an array of doubles, an int low, an int high, the number of threads to use
+ * output: the root of a tree
+ *
+ * Builds the same tree as constructSegmentTree.  For the top levels each split hands the left half of the
+ * array to a new thread and builds the right half itself, so about numThreads subtrees are built at once.
+ */
+TNode* constructSegmentTreeParallel( double* points, int low, int high, int numThreads )
+{
+    BuildTask task;
+
+    task.points = points;
+    task.low = low;
+    task.high = high;
+    task.forkDepth = forkDepthFor( numThreads );
+    buildSegmentTreeTask( &task );
+    return task.root;
+}
+
+void* buildSegmentTreeTask( void* arg )
+{
+    BuildTask* task = (BuildTask*)arg;
+    BuildTask left, right;
+    pthread_t thread;
+    int mid = (task->high - task->low)/2 + task->low;
+
+    if( task->forkDepth==0 || task->low==task->high ){
+        task->root = constructSegmentTree( task->points, task->low, task->high );
+        if( STATS_ENABLED )
+            flushStats( ); /* this may be a worker thread */
+        return NULL;
+    }
+
+    left.points = right.points = task->points;
+    left.low = task->low;
+    left.high = mid;
+    right.low = mid+1;
+    right.high = task->high;
+    left.forkDepth = right.forkDepth = task->forkDepth-1;
+
+    /* build the left half on a new thread (or here if no thread can be started) */
+    if( pthread_create( &thread, NULL, buildSegmentTreeTask, &left )!=0 ){
+        buildSegmentTreeTask( &left );
+        buildSegmentTreeTask( &right );
+    }
+    else{
+        buildSegmentTreeTask( &right );
+        pthread_join( thread, NULL );
+    }
+
+    task->root = createTNode( );
+    task->root->cnt = 0;
+    task->root->low = task->points[task->low];
+    task->root->high = task->points[task->high];
+    attachChildNodes( task->root, left.root, right.root );
+    return NULL;
+}
+
+/* forkDepthFor
+ * input: a number of threads
+ * output: the number of levels that must fork for 2^levels >= numThreads
+ */
+int forkDepthFor( int numThreads )
+{
+    int depth = 0;
+    while( (1<<depth) < numThreads )
+        depth++;
+    return depth;
+}
+
+/* insertSegmentsParallel
+ * input: the root of a tree, arrays with the start and end of each segment, the number of segments, the number of threads
+ * output: none
+ *
+ * Gives the same cnt values as calling insertSegment for every segment.  The top few levels of the tree are cut
+ * off at a frontier with several subtrees per thread.  Phase 1: each thread routes its share of the segments
+ * through the top, counting cnt increments for the top TNodes in a private array and bucketing the segments that
+ * reach each frontier TNode.  The private counts are then merged.  Phase 2: each thread inserts the bucketed
+ * segments into the frontier subtrees it owns, so no two threads ever touch the same TNode.
+ */
+void insertSegmentsParallel( TNode* root, double* segmentStart, double* segmentEnd, int numSegments, int numThreads )
+{
+    InsertBatch batch;
+    InsertTask* tasks;
+    pthread_t* threads;
+    bool* started;
+    int i, t, frontierDepth;
+
+    if( root==NULL || numSegments==0 )
+        return;
+    if( numThreads < 1 )
+        numThreads = 1;
+
+    /* about four frontier subtrees per thread so uneven subtrees still balance out */
+    frontierDepth = forkDepthFor( numThreads ) + 2;
+    batch.numSlots = (1<<(frontierDepth+1)) - 1;
+    batch.nodes = (TNode**)calloc( batch.numSlots, sizeof(TNode*) );
+    batch.isFrontier = (bool*)calloc( batch.numSlots, sizeof(bool) );
+    batch.segmentStart = segmentStart;
+    batch.segmentEnd = segmentEnd;
+    batch.numThreads = numThreads;
+    collectTopNodes( &batch, root, 0, 0, frontierDepth );
+
+    tasks = (InsertTask*)malloc( numThreads*sizeof(InsertTask) );
+    threads = (pthread_t*)malloc( numThreads*sizeof(pthread_t) );
+    started = (bool*)malloc( numThreads*sizeof(bool) );
+    for( t=0; t<numThreads; t++ ){
+        tasks[t].batch = &batch;
+        tasks[t].thread = t;
+        tasks[t].first = (long)numSegments*t/numThreads;
+        tasks[t].last = (long)numSegments*(t+1)/numThreads;
+        tasks[t].topCnt = (int*)calloc( batch.numSlots, sizeof(int) );
+        tasks[t].buckets = (SegmentBucket*)calloc( batch.numSlots, sizeof(SegmentBucket) );
+        tasks[t].allTasks = tasks;
+    }
+
+    /* phase 1: route the segments through the top of the tree (a task runs here if no thread can be started) */
+    for( t=1; t<numThreads; t++ ){
+        started[t] = pthread_create( &threads[t], NULL, routeSegmentsTask, &tasks[t] )==0;
+        if( !started[t] )
+            routeSegmentsTask( &tasks[t] );
+    }
+    routeSegmentsTask( &tasks[0] );
+    for( t=1; t<numThreads; t++ )
+        if( started[t] )
+            pthread_join( threads[t], NULL );
+
+    /* merge the private cnt increments */
+    for( t=0; t<numThreads; t++ ){
+        for( i=0; i<batch.numSlots; i++ ){
+            if( batch.nodes[i]!=NULL )
+                batch.nodes[i]->cnt += tasks[t].topCnt[i];
+        }
+    }
+
+    /* phase 2: fill the frontier subtrees */
+    for( t=1; t<numThreads; t++ ){
+        started[t] = pthread_create( &threads[t], NULL, insertFrontierTask, &tasks[t] )==0;
+        if( !started[t] )
+            insertFrontierTask( &tasks[t] );
+    }
+    insertFrontierTask( &tasks[0] );
+    for( t=1; t<numThreads; t++ )
+        if( started[t] )
+            pthread_join( threads[t], NULL );
+
+    for( t=0; t<numThreads; t++ ){
+        for( i=0; i<batch.numSlots; i++ )
+            free( tasks[t].buckets[i].segments );
+        free( tasks[t].buckets );
+        free( tasks[t].topCnt );
+    }
+    free( tasks );
+    free( threads );
+    free( started );
+    free( batch.nodes );
+    free( batch.isFrontier );
+}
+
+/* collectTopNodes
+ * input: the batch, a TNode, its heap index, its depth, the depth of the frontier
+ * output: none
+ *
+ * Stores the TNodes above the frontier in heap order.  Leaves above the frontier depth are frontier TNodes too.
+ */
+void collectTopNodes( InsertBatch* batch, TNode* x, int i, int depth, int frontierDepth )
+{
+    batch->nodes[i] = x;
+    if( depth==frontierDepth || x->pLeft==NULL || x->pRight==NULL ){
+        batch->isFrontier[i] = true;
+        return;
+    }
+    collectTopNodes( batch, x->pLeft, 2*i+1, depth+1, frontierDepth );
+    collectTopNodes( batch, x->pRight, 2*i+2, depth+1, frontierDepth );
+}
+
+void* routeSegmentsTask( void* arg )
+{
+    InsertTask* task = (InsertTask*)arg;
+    int s;
+
+    for( s=task->first; s<task->last; s++ )
+        routeSegment( task, 0, s );
+    if( STATS_ENABLED )
+        flushStats( ); /* this may be a worker thread */
+    return NULL;
+}
+
+/* routeSegment
+ * input: a task, the heap index of a top TNode, the index of a segment
+ * output: none
+ *
+ * insertSegment restricted to the top of the tree: stops at frontier TNodes and remembers the segment there
+ */
+void routeSegment( InsertTask* task, int i, int segment )
+{
+    InsertBatch* batch = task->batch;
+    TNode* x = batch->nodes[i];
+    double segmentStart = batch->segmentStart[segment];
+    double segmentEnd = batch->segmentEnd[segment];
+    SegmentBucket* bucket;
+
+    if( segmentEnd < x->low || segmentStart > x->high )
+        return;
+
+    if( segmentStart <= x->low && x->high <= segmentEnd ){
+        task->topCnt[i]++;
+        return;
+    }
+
+    if( batch->isFrontier[i] ){
+        bucket = &task->buckets[i];
+        if( bucket->size==bucket->capacity ){
+            bucket->capacity = bucket->capacity==0 ? 16 : 2*bucket->capacity;
+            bucket->segments = (int*)realloc( bucket->segments, bucket->capacity*sizeof(int) );
+        }
+        bucket->segments[bucket->size++] = segment;
+        return;
+    }
+
+    routeSegment( task, 2*i+1, segment );
+    routeSegment( task, 2*i+2, segment );
+}
+
+void* insertFrontierTask( void* arg )
+{
+    InsertTask* task = (InsertTask*)arg;
+    InsertBatch* batch = task->batch;
+    SegmentBucket* bucket;
+    int i, t, j, frontierCount = 0;
+
+    /* frontier TNodes are dealt out round robin */
+    for( i=0; i<batch->numSlots; i++ ){
+        if( batch->nodes[i]==NULL || !batch->isFrontier[i] )
+            continue;
+        if( frontierCount++ % batch->numThreads != task->thread )
+            continue;
+        for( t=0; t<batch->numThreads; t++ ){
+            bucket = &task->allTasks[t].buckets[i];
+            for( j=0; j<bucket->size; j++ )
+                insertSegment( batch->nodes[i], batch->segmentStart[bucket->segments[j]], batch->segmentEnd[bucket->segments[j]] );
+        }
+    }
+    if( STATS_ENABLED )
+        flushStats( ); /* this may be a worker thread */
+    return NULL;
+}
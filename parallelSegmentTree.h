@@ -0,0 +1,15 @@
+#ifndef _parallelSegmentTree_h
+#define _parallelSegmentTree_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "tree.h"
+
+/**********  Functions for building/filling a segment tree with several threads **********/
+TNode* constructSegmentTreeParallel( double* points, int low, int high, int numThreads );
+void insertSegmentsParallel( TNode* root, double* segmentStart, double* segmentEnd, int numSegments, int numThreads );
+
+#endif
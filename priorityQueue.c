@@ -1,4 +1,5 @@
 #include "priorityQueue.h"
+#include "stats.h"
 
 /*
  * Default starting size for the PriorityQueue
@@ -52,6 +53,7 @@ pqType removePQ( PriorityQueue *ppq ){
     left = 2*cur + 1;
     right = 2*cur + 2;
     while( right <= ppq->last ){ //Move down heap and check priority of left and right
+        STATS_INC( siftLevels );
         if( ppq->data[left]->priority <= ppq->data[right]->priority && ppq->data[left]->priority < last->priority ){
             ppq->data[cur] = ppq->data[left];
             cur = left;
@@ -68,6 +70,7 @@ pqType removePQ( PriorityQueue *ppq ){
         right = 2*cur + 2;
     }
     if( left <= ppq->last && ppq->data[left]->priority < last->priority ){ //Check left element if still in valid range
+        STATS_INC( siftLevels );
         ppq->data[cur] = ppq->data[left];
         cur = left;
     }
@@ -87,6 +90,7 @@ void insertPQ( PriorityQueue *ppq, pqType pt ){
         /* resize the array */
         ppq->capacity *= 2;
         ppq->data = (pqType*)realloc( ppq->data, ppq->capacity*sizeof(pqType) );
+        STATS_INC( allocations );
     }
     ppq->last++;
     cur = ppq->last;
@@ -96,6 +100,7 @@ void insertPQ( PriorityQueue *ppq, pqType pt ){
         parent = -1;
 
     while( parent>=0 && ppq->data[parent]->priority > pt->priority ){ //Ascend heap until pt's priority is correctly ordered
+        STATS_INC( siftLevels );
         ppq->data[cur] = ppq->data[parent];
         cur = parent;
         if( parent == 0 )
@@ -146,3 +151,25 @@ bool isFullPQ( PriorityQueue *ppq ){
     }
     return false;
 }
+
+/* memoryUsagePQ
+ * input: a pointer to a PriorityQueue
+ * output: the bytes used by the PriorityQueue, its array and the Huffman subtrees it holds
+ *
+ * The unused capacity of the array counts as overhead.  Every queued TNode is counted with its whole subtree
+ * (and str buffers), since while a Huffman tree is being built the queue holds the whole forest.
+ */
+MemoryUsage memoryUsagePQ( PriorityQueue *ppq ){
+    MemoryUsage mu, subtree;
+    int i;
+
+    resetMemoryUsage( &mu );
+    addNodeMemory( &mu, ppq, sizeof(PriorityQueue) );
+    addArrayMemory( &mu, ppq->data, (ppq->last+1)*sizeof(pqType), ppq->capacity*sizeof(pqType) );
+    for( i=0; i<=ppq->last; i++ ){
+        subtree = memoryUsageTNodes( ppq->data[i], HUFFMAN );
+        addMemoryUsage( &mu, &subtree );
+    }
+    mu.numElements = ppq->last+1;
+    return mu;
+}
@@ -23,5 +23,6 @@ pqType getNextPQ( PriorityQueue *ppq );
 
 bool isEmptyPQ( PriorityQueue *ppq );
 bool isFullPQ( PriorityQueue *ppq );
+MemoryUsage memoryUsagePQ( PriorityQueue *ppq );
 
 #endif
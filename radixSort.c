@@ -0,0 +1,90 @@
+#include "radixSort.h"
+
+/**********  Functions for sorting doubles **********/
+
+/* sortUniqueDoubles
+ * input: an array of doubles, its size
+ * output: the number of unique values, which are at the front of the array in increasing order
+ *
+ * LSD radix sort on the IEEE-754 bits (RADIX_BITS per pass).  The bits are mapped so that unsigned order is
+ * numeric order, and passes where every key has the same digit are skipped.  The pass that turns the keys
+ * back into doubles also drops the duplicates.  Gives the same array as sorting with qsort and then dropping
+ * repeated values (-0.0 is stored as 0.0).
+ */
+int sortUniqueDoubles( double* points, int size ){
+    int numDigits = (64 + RADIX_BITS - 1)/RADIX_BITS;
+    int numBuckets = 1<<RADIX_BITS;
+    uint64_t* keys = (uint64_t*) malloc( size*sizeof( uint64_t ) );
+    uint64_t* buffer = (uint64_t*) malloc( size*sizeof( uint64_t ) );
+    int* counts = (int*) calloc( numDigits*numBuckets, sizeof( int ) );
+    uint64_t* swap;
+    int i, d, shift, sum, bucket, numUnique = 0;
+
+    /* one read to build the keys and every histogram */
+    for( i=0; i<size; i++ ){
+        keys[i] = doubleToRadixKey( points[i] );
+        for( d=0; d<numDigits; d++ )
+            counts[d*numBuckets + ((keys[i] >> (d*RADIX_BITS)) & (numBuckets-1))]++;
+    }
+
+    for( d=0; d<numDigits; d++ ){
+        int* count = &counts[d*numBuckets];
+        shift = d*RADIX_BITS;
+        if( size==0 || count[(keys[0] >> shift) & (numBuckets-1)]==size )
+            continue; /* every key has the same digit here */
+
+        /* turn the histogram into starting offsets and scatter (stable) */
+        sum = 0;
+        for( bucket=0; bucket<numBuckets; bucket++ ){
+            int c = count[bucket];
+            count[bucket] = sum;
+            sum += c;
+        }
+        for( i=0; i<size; i++ )
+            buffer[count[(keys[i] >> shift) & (numBuckets-1)]++] = keys[i];
+        swap = keys;
+        keys = buffer;
+        buffer = swap;
+    }
+
+    /* back to doubles, dropping duplicates */
+    for( i=0; i<size; i++ ){
+        if( numUnique==0 || keys[i]!=keys[i-1] )
+            points[numUnique++] = radixKeyToDouble( keys[i] );
+    }
+
+    free( keys );
+    free( buffer );
+    free( counts );
+    return numUnique;
+}
+
+
+/**********  Functions for mapping doubles to radix keys **********/
+
+/* doubleToRadixKey
+ * input: a double
+ * output: a key whose unsigned order is the numeric order of the doubles
+ *
+ * Positive doubles get the sign bit set, negative doubles have every bit flipped.  -0.0 becomes the key of 0.0.
+ */
+uint64_t doubleToRadixKey( double value ){
+    uint64_t bits;
+
+    if( value==0 )
+        value = 0; /* -0.0 == 0.0 */
+    memcpy( &bits, &value, sizeof( bits ) );
+    return (bits >> 63) ? ~bits : bits | (1ULL<<63);
+}
+
+/* radixKeyToDouble
+ * input: a key made by doubleToRadixKey
+ * output: the double it was made from
+ */
+double radixKeyToDouble( uint64_t key ){
+    uint64_t bits = (key >> 63) ? key & ~(1ULL<<63) : ~key;
+    double value;
+
+    memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
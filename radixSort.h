@@ -0,0 +1,16 @@
+#ifndef _radixSort_h
+#define _radixSort_h
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define RADIX_BITS 16   /* bits per LSD radix sort pass (4 passes cover the 64 bits of a double) */
+
+/**********  Functions for sorting doubles **********/
+int sortUniqueDoubles( double* points, int size );
+
+/**********  Functions for mapping doubles to radix keys **********/
+uint64_t doubleToRadixKey( double value );
+double radixKeyToDouble( uint64_t key );
+
+#endif
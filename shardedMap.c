@@ -0,0 +1,230 @@
+#include "shardedMap.h"
+
+/**********  Helper functions for a sharded map **********/
+int compareKeyPointers( const void* a, const void* b );
+
+/**********  Functions for creating/freeing a sharded map **********/
+
+/* createShardedMap
+ * input: the number of shards, the numShards-1 keys splitting the shards (increasing, they are copied)
+ * output: a pointer to a ShardedMap (this is malloc-ed so must be freed eventually with freeShardedMap!)
+ *
+ * Creates an empty ordered map that range-partitions the keys over numShards AVL trees, each with its own
+ * lock, so threads working on different ranges never wait for each other
+ */
+ShardedMap* createShardedMap( int numShards, char** splitKeys )
+{
+    ShardedMap* sm = (ShardedMap*)malloc( sizeof(ShardedMap) );
+    int i;
+
+    if( numShards < 1 )
+        numShards = 1;
+    sm->numShards = numShards;
+    sm->splitKeys = (char**)malloc( numShards*sizeof(char*) );
+    for( i=0; i<numShards-1; i++ ){
+        sm->splitKeys[i] = (char*)malloc( (strlen( splitKeys[i] )+1)*sizeof(char) );
+        strcpy( sm->splitKeys[i], splitKeys[i] );
+    }
+    sm->shards = (Shard*)aligned_alloc( SHARD_ALIGNMENT, numShards*sizeof(Shard) );
+    for( i=0; i<numShards; i++ ){
+        sm->shards[i].tree = createTree( );
+        sm->shards[i].tree->type = AVL;
+        pthread_mutex_init( &sm->shards[i].lock, NULL );
+    }
+    return sm;
+}
+
+/* createShardedMapFromSample
+ * input: the number of shards, a sample of the keys that will be stored, the size of the sample
+ * output: a pointer to a ShardedMap (this is malloc-ed so must be freed eventually with freeShardedMap!)
+ *
+ * Splits the shards at the quantiles of the sample so each shard gets about the same share of the keys
+ */
+ShardedMap* createShardedMapFromSample( int numShards, char** sampleKeys, int numSamples )
+{
+    char** sorted;
+    char** splitKeys;
+    ShardedMap* sm;
+    int i;
+
+    if( numSamples==0 )
+        return createShardedMap( 1, NULL );
+    sorted = (char**)malloc( numSamples*sizeof(char*) );
+    splitKeys = (char**)malloc( numShards*sizeof(char*) );
+    memcpy( sorted, sampleKeys, numSamples*sizeof(char*) );
+    qsort( sorted, numSamples, sizeof(char*), compareKeyPointers );
+    for( i=1; i<numShards; i++ )
+        splitKeys[i-1] = sorted[ (long)numSamples*i/numShards ];
+
+    sm = createShardedMap( numShards, splitKeys );
+    free( sorted );
+    free( splitKeys );
+    return sm;
+}
+
+int compareKeyPointers( const void* a, const void* b )
+{
+    return strcmp( *(char* const*)a, *(char* const*)b );
+}
+
+/* freeShardedMap
+ * input: a pointer to a ShardedMap
+ * output: none
+ *
+ * Frees the map, its trees and all of the Data they hold
+ */
+void freeShardedMap( ShardedMap* sm )
+{
+    int i;
+
+    for( i=0; i<sm->numShards; i++ ){
+        freeTree( sm->shards[i].tree );
+        pthread_mutex_destroy( &sm->shards[i].lock );
+    }
+    for( i=0; i<sm->numShards-1; i++ )
+        free( sm->splitKeys[i] );
+    free( sm->splitKeys );
+    free( sm->shards );
+    free( sm );
+}
+
+
+/**********  Functions for searching/inserting/removing (safe from several threads) **********/
+
+/* findShard
+ * input: a pointer to a ShardedMap, a key
+ * output: the index of the shard whose range holds key
+ *
+ * Binary search for the number of split keys <= key
+ */
+int findShard( ShardedMap* sm, char* key )
+{
+    int low = 0, high = sm->numShards-1, mid;
+
+    while( low<high ){
+        mid = (low+high)/2;
+        if( strcmp( key, sm->splitKeys[mid] )<0 )
+            high = mid;
+        else
+            low = mid+1;
+    }
+    return low;
+}
+
+/* searchShardedMap
+ * input: a pointer to a ShardedMap, a Data* holding the key to find
+ * output: the Data* with the key or NULL if it is not stored
+ *
+ * Like searchTree, but returns the Data rather than its TNode: removing any other key of the shard can free
+ * or reuse the TNode as soon as the lock is released, while the Data stays valid until its own key is removed.
+ */
+Data* searchShardedMap( ShardedMap* sm, Data* tData )
+{
+    Shard* s = &sm->shards[ findShard( sm, tData->key ) ];
+    TNode* found;
+    Data* d = NULL;
+
+    pthread_mutex_lock( &s->lock );
+    found = searchTree( s->tree, tData );
+    if( found!=NULL )
+        d = found->data;
+    pthread_mutex_unlock( &s->lock );
+    return d;
+}
+
+/* insertShardedMap
+ * input: a pointer to a ShardedMap, a Data*
+ * output: true if tData was stored, false if its key was already stored (tData still belongs to the caller)
+ *
+ * Like insertTreeBalanced.  The check and the insert happen under one lock, so when several threads insert
+ * the same key exactly one of them gets true.
+ */
+bool insertShardedMap( ShardedMap* sm, Data* tData )
+{
+    Shard* s = &sm->shards[ findShard( sm, tData->key ) ];
+    bool inserted = false;
+
+    pthread_mutex_lock( &s->lock );
+    if( searchTree( s->tree, tData )==NULL ){
+        insertTreeBalanced( s->tree, tData );
+        inserted = true;
+    }
+    pthread_mutex_unlock( &s->lock );
+    return inserted;
+}
+
+/* removeShardedMap
+ * input: a pointer to a ShardedMap, a key
+ * output: the Data* with the key or NULL if it is not stored
+ *
+ * Like removeTree
+ */
+Data* removeShardedMap( ShardedMap* sm, char* key )
+{
+    Shard* s = &sm->shards[ findShard( sm, key ) ];
+    Data* removed;
+
+    pthread_mutex_lock( &s->lock );
+    removed = removeTree( s->tree, key );
+    pthread_mutex_unlock( &s->lock );
+    return removed;
+}
+
+
+/**********  Functions for iterating over a sharded map in order **********/
+
+/* initShardedMapIterator
+ * input: a pointer to a ShardedMapIterator, a pointer to a ShardedMap
+ * output: none
+ *
+ * Starts an ordered scan of every key in the map.  The ranges of the shards do not overlap, so merging the
+ * shards in order is just running their iterators one after the other.  No thread may modify the map
+ * during the scan.
+ */
+void initShardedMapIterator( ShardedMapIterator* it, ShardedMap* sm )
+{
+    it->map = sm;
+    it->shard = 0;
+    initTreeIterator( &it->it, sm->shards[0].tree->root );
+}
+
+/* nextShardedMapIterator
+ * input: a pointer to a ShardedMapIterator
+ * output: the TNode with the next key in increasing order or NULL once every key has been returned
+ */
+TNode* nextShardedMapIterator( ShardedMapIterator* it )
+{
+    TNode* next = nextTreeIterator( &it->it );
+
+    while( next==NULL && it->shard < it->map->numShards-1 ){
+        it->shard++;
+        initTreeIterator( &it->it, it->map->shards[it->shard].tree->root );
+        next = nextTreeIterator( &it->it );
+    }
+    return next;
+}
+
+
+/**********  Functions for measuring the memory of a sharded map **********/
+
+/* memoryUsageShardedMap
+ * input: a pointer to a ShardedMap
+ * output: the bytes used by the map, its split keys and every shard's tree
+ */
+MemoryUsage memoryUsageShardedMap( ShardedMap* sm )
+{
+    MemoryUsage mu, treeMu;
+    int i;
+
+    resetMemoryUsage( &mu );
+    addNodeMemory( &mu, sm, sizeof(ShardedMap) );
+    addNodeMemory( &mu, sm->splitKeys, (sm->numShards-1)*sizeof(char*) );
+    for( i=0; i<sm->numShards-1; i++ )
+        addNodeMemory( &mu, sm->splitKeys[i], strlen( sm->splitKeys[i] )+1 );
+    addNodeMemory( &mu, sm->shards, sm->numShards*sizeof(Shard) );
+    for( i=0; i<sm->numShards; i++ ){
+        treeMu = memoryUsageTree( sm->shards[i].tree );
+        addMemoryUsage( &mu, &treeMu );
+    }
+    return mu;
+}
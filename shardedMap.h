@@ -0,0 +1,53 @@
+#ifndef _shardedMap_h
+#define _shardedMap_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "tree.h"
+#include "data.h"
+#include "memoryUsage.h"
+
+#define SHARD_ALIGNMENT 64  /* every Shard starts on its own cache line so locking one does not slow its neighbours */
+
+typedef struct Shard
+{
+    Tree* tree;             /* AVL tree holding the keys of this shard's range */
+    pthread_mutex_t lock;   /* guards tree */
+}  __attribute__((aligned(SHARD_ALIGNMENT))) Shard;
+
+typedef struct ShardedMap
+{
+    int numShards;          /* number of key ranges (and AVL trees) */
+    char** splitKeys;       /* numShards-1 increasing boundaries: shard i holds the keys k with splitKeys[i-1] <= k < splitKeys[i] */
+    Shard* shards;          /* the shards in key order */
+}  ShardedMap;
+
+typedef struct ShardedMapIterator
+{
+    ShardedMap* map;        /* the map being iterated */
+    int shard;              /* the shard being iterated */
+    TreeIterator it;        /* position inside that shard's tree */
+}  ShardedMapIterator;
+
+/**********  Functions for creating/freeing a sharded map **********/
+ShardedMap* createShardedMap( int numShards, char** splitKeys );
+ShardedMap* createShardedMapFromSample( int numShards, char** sampleKeys, int numSamples );
+void freeShardedMap( ShardedMap* sm );
+
+/**********  Functions for searching/inserting/removing (safe from several threads) **********/
+int findShard( ShardedMap* sm, char* key );
+Data* searchShardedMap( ShardedMap* sm, Data* tData );
+bool insertShardedMap( ShardedMap* sm, Data* tData );
+Data* removeShardedMap( ShardedMap* sm, char* key );
+
+/**********  Functions for iterating over a sharded map in order **********/
+void initShardedMapIterator( ShardedMapIterator* it, ShardedMap* sm );
+TNode* nextShardedMapIterator( ShardedMapIterator* it );
+
+/**********  Functions for measuring the memory of a sharded map **********/
+MemoryUsage memoryUsageShardedMap( ShardedMap* sm );
+
+#endif
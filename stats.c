@@ -0,0 +1,93 @@
+#include <pthread.h>
+
+#include "stats.h"
+
+_Thread_local TreeStats threadStats;
+
+/* counters flushed by threads (guarded by statsLock) */
+TreeStats totalStats;
+pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* flushStats
+ * input: none
+ * output: none
+ *
+ * Adds the calling thread's counters to the process totals and zeroes them.  Worker threads call this
+ * before they exit so their counts aren't lost.
+ */
+void flushStats( )
+{
+    pthread_mutex_lock( &statsLock );
+    addStats( &totalStats, &threadStats );
+    pthread_mutex_unlock( &statsLock );
+    memset( &threadStats, 0, sizeof(TreeStats) );
+}
+
+/* resetStats
+ * input: none
+ * output: none
+ *
+ * Zeroes the process totals and the calling thread's counters
+ */
+void resetStats( )
+{
+    pthread_mutex_lock( &statsLock );
+    memset( &totalStats, 0, sizeof(TreeStats) );
+    pthread_mutex_unlock( &statsLock );
+    memset( &threadStats, 0, sizeof(TreeStats) );
+}
+
+/* getStats
+ * input: none
+ * output: the process totals plus the calling thread's unflushed counters
+ */
+TreeStats getStats( )
+{
+    TreeStats s;
+
+    pthread_mutex_lock( &statsLock );
+    s = totalStats;
+    pthread_mutex_unlock( &statsLock );
+    addStats( &s, &threadStats );
+    return s;
+}
+
+/* printStatsJSON
+ * input: a stream, a name for the counters (e.g. a benchmark case), the counters
+ * output: none
+ *
+ * Prints the counters as one JSON object per line
+ */
+void printStatsJSON( FILE* out, char* name, TreeStats* s )
+{
+    fprintf( out, "{\"name\": \"%s\", \"enabled\": %s, \"compares\": %ld, \"rotations\": %ld, \"heightUpdates\": %ld, "
+        "\"siftLevels\": %ld, \"segmentVisits\": %ld, \"allocations\": %ld}\n", name, STATS_ENABLED ? "true" : "false",
+        s->compares, s->rotations, s->heightUpdates, s->siftLevels, s->segmentVisits, s->allocations );
+}
+
+/* addStats and diffStats
+ * input: two sets of counters
+ * output: none / after - before
+ */
+void addStats( TreeStats* total, TreeStats* s )
+{
+    total->compares += s->compares;
+    total->rotations += s->rotations;
+    total->heightUpdates += s->heightUpdates;
+    total->siftLevels += s->siftLevels;
+    total->segmentVisits += s->segmentVisits;
+    total->allocations += s->allocations;
+}
+
+TreeStats diffStats( TreeStats* after, TreeStats* before )
+{
+    TreeStats d;
+
+    d.compares = after->compares - before->compares;
+    d.rotations = after->rotations - before->rotations;
+    d.heightUpdates = after->heightUpdates - before->heightUpdates;
+    d.siftLevels = after->siftLevels - before->siftLevels;
+    d.segmentVisits = after->segmentVisits - before->segmentVisits;
+    d.allocations = after->allocations - before->allocations;
+    return d;
+}
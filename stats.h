@@ -0,0 +1,41 @@
+#ifndef _stats_h
+#define _stats_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Build with -DTREE_STATS (make STATS=1) to count what the structures do.  Without it every STATS_* macro
+ * expands to nothing and the hot paths are unchanged. */
+#ifdef TREE_STATS
+#define STATS_ENABLED true
+#define STATS_INC( counter ) (threadStats.counter++)
+#define STATS_ADD( counter, n ) (threadStats.counter += (n))
+#else
+#define STATS_ENABLED false
+#define STATS_INC( counter ) ((void)0)
+#define STATS_ADD( counter, n ) ((void)0)
+#endif
+
+typedef struct TreeStats
+{
+    long compares;          /* compareData calls */
+    long rotations;         /* AVL rotations (including the persistent copy-on-write ones) */
+    long heightUpdates;     /* TNodes whose height updateHeights recomputed */
+    long siftLevels;        /* levels moved by insertPQ/removePQ */
+    long segmentVisits;     /* segment tree TNodes visited by inserts and stabbing queries */
+    long allocations;       /* TNode/BNode/DNode/INode mallocs and priority queue array growths */
+}  TreeStats;
+
+/* Each thread counts into its own copy, so counting needs no atomics */
+extern _Thread_local TreeStats threadStats;
+
+/**********  Functions for collecting/reporting statistics **********/
+void flushStats( );
+void resetStats( );
+TreeStats getStats( );
+void addStats( TreeStats* total, TreeStats* s );
+TreeStats diffStats( TreeStats* after, TreeStats* before );
+void printStatsJSON( FILE* out, char* name, TreeStats* s );
+
+#endif
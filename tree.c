@@ -1,4 +1,7 @@
 #include "tree.h"
+#include "hashIndex.h"
+#include "stats.h"
+#include "keyIntern.h"
 
 /**********  Helper functions for removing from an AVL tree **********/
 TNode* removeNextInorder( TNode** pRoot );
@@ -13,6 +16,27 @@ TNode* getTallerSubTree(TNode* root);
 bool isSameSignBalance(TNode* x, TNode* z);
 int subTreeHeight(TNode* root);
 
+/**********  Helper functions for the hash index **********/
+void indexTNodes( HashIndex* h, TNode* root );
+
+/**********  Helper functions for a persistent AVL tree **********/
+TNode* retainTNode( TNode* root );
+TNode* ownTNode( TNode* root );
+TNode* createPersistentTNode( Data* tData, TNode* left, TNode* right );
+TNode* rebalancePersistent( TNode* x );
+TNode* rightRotatePersistent( TNode* oldRoot );
+TNode* leftRotatePersistent( TNode* oldRoot );
+TNode* insertNodePersistent( TNode* root, Data* tData );
+TNode* removeNodePersistent( TNode* root, Data* tData, Data** pData );
+TNode* removeMinPersistent( TNode* root );
+
+/**********  Helper functions for a splay tree **********/
+void splay( Tree* t, TNode* x );
+void rotateUp( Tree* t, TNode* x );
+
+/**********  Helper functions for a segment tree **********/
+void lineStabQueryBatchRec( TNode* root, double* queryPoints, int numPoints, int* pNext, int cnt, int* results );
+
 /* createTree
  * input: none
  * output: a pointer to a Tree (this is malloc-ed so must be freed eventually!)
@@ -23,6 +47,7 @@ Tree *createTree( )
 {
     Tree* t = (Tree*)malloc( sizeof(Tree) );
     t->root = NULL;
+    t->index = NULL;
 
     return t;
 }
@@ -31,6 +56,7 @@ Tree *createTreeFromTNode( TNode* root )
 {
     Tree* t = (Tree*)malloc( sizeof(Tree) );
     t->root = root;
+    t->index = NULL;
 
     return t;
 }
@@ -59,7 +85,9 @@ void attachChildNodes( TNode* root, TNode* left, TNode* right ){
  */
 TNode* createTNode( ){
     TNode* newNode = (TNode*)malloc( sizeof(TNode) );
+    STATS_INC( allocations );
     newNode->height = 1;
+    newNode->refCnt = 1;
     newNode->pParent = NULL;
     attachChildNodes( newNode, NULL, NULL );
     return newNode;
@@ -74,22 +102,41 @@ TNode* createTNode( ){
 void freeTree( Tree *t )
 {
     freeTreeContents(t->root, t->type);
+    if(t->index!=NULL)
+        freeHashIndex(t->index);
     free(t);
 }
 
 void freeTreeContents( TNode *root, treeType type )
 {
+    TNode* left;
+
     if(root==NULL)
         return;
+    if(type==PERSISTENT){
+        /* nodes may be shared with other versions, so only drop this version's reference */
+        releaseTNode(root);
+        return;
+    }
 
-    freeTreeContents(root->pLeft, type);
-    freeTreeContents(root->pRight, type);
-    if(type==AVL && root->data!=NULL)
-        freeData(root->data);
-    if(type==HUFFMAN && root->str!=NULL)
-        free(root->str);
-
-    free(root);
+    /* Rotate left children up until root has none, then free root and continue with its right child.
+     * This needs no stack, so even a degenerate (unbalanced) tree can't overflow it. */
+    while(root!=NULL){
+        if(root->pLeft!=NULL){
+            left = root->pLeft;
+            root->pLeft = left->pRight;
+            left->pRight = root;
+            root = left;
+            continue;
+        }
+        left = root->pRight;
+        if((type==AVL || type==SPLAY) && root->data!=NULL)
+            freeData(root->data);
+        if(type==HUFFMAN && root->str!=NULL)
+            free(root->str);
+        free(root);
+        root = left;
+    }
 }
 
 TNode* getTallerSubTree(TNode* x)
@@ -129,20 +176,33 @@ bool isSameSignBalance(TNode* x, TNode* z)
  * output: a pointer to the TNode that contains tData or, if no such node exists, NULL
  *
  * Finds and returns a pointer to the TNode that contains tData or, if no such node exists, it returns a NULL
+ * If the tree has a hash index the lookup goes through it instead of walking down the tree.  SPLAY trees move
+ * the TNode to the root (see searchTreeSplay).
  */
 TNode* searchTree( Tree *t, Data* tData )
 {
+    if( t->type==SPLAY )
+        return searchTreeSplay( t, tData );
+    if( t->index!=NULL )
+        return searchHashIndex( t->index, tData );
     return searchTreeRec( t->root, tData );
 }
 
 TNode* searchTreeRec( TNode *root, Data* tData )
 {
-    if( root==NULL || compareData( tData, root->data ) == 0 )
-        return root;
-    else if( compareData( tData, root->data ) < 0 )
-        return searchTreeRec( root->pLeft, tData );
-    else /* compareData( tData, root->data ) > 0 */
-        return searchTreeRec( root->pRight, tData );
+    int cmp;
+
+    /* walks down the tree in a loop (one compare per level) rather than recursing */
+    while( root!=NULL ){
+        cmp = compareData( tData, root->data );
+        if( cmp == 0 )
+            return root;
+        else if( cmp < 0 )
+            root = root->pLeft;
+        else /* cmp > 0 */
+            root = root->pRight;
+    }
+    return NULL;
 }
 
 
@@ -152,57 +212,96 @@ TNode* searchTreeRec( TNode *root, Data* tData )
  * input: a pointer to a TNode, a Data*
  * output: none
  *
- * Stores the passed Data* in the given tree, does not rebalance tree
+ * Stores the passed Data* in the given tree, does not rebalance tree.  If the key is already stored newNode is
+ * left unlinked (pParent stays NULL) and the caller must free it.
  */
 TNode* insertNode( TNode *root, TNode* newNode )
 {
+    TNode* cur = root;
+    int cmp;
+
     if( root==NULL )
         return newNode;
-    if( compareData( newNode->data, root->data ) == 0 ){
-        free( newNode );
-        return root;
-    }
-    else if( compareData( newNode->data, root->data ) < 0 ){
-        root->pLeft = insertNode( root->pLeft, newNode );
-        if( root->pLeft!=NULL )
-          root->pLeft->pParent = root;
-        return root;
-    }
-    else{ /* compareData( newNode->data, root->data ) > 0 */
-        root->pRight = insertNode( root->pRight, newNode );
-        if( root->pRight!=NULL )
-          root->pRight->pParent = root;
-        return root;
+
+    /* walk down to the empty link where newNode belongs */
+    while( true ){
+        cmp = compareData( newNode->data, cur->data );
+        if( cmp == 0 )
+            return root;
+        else if( cmp < 0 ){
+            if( cur->pLeft==NULL ){
+                cur->pLeft = newNode;
+                break;
+            }
+            cur = cur->pLeft;
+        }
+        else{ /* cmp > 0 */
+            if( cur->pRight==NULL ){
+                cur->pRight = newNode;
+                break;
+            }
+            cur = cur->pRight;
+        }
     }
+    newNode->pParent = cur;
+    return root;
 }
 
 /* insertTree
  * input: a pointer to a Tree, a Data*
  * output: none
  *
- * Stores the passed Data* into the Tree following BST order, Does not rebalance tree
+ * Stores the passed Data* into the Tree following BST order, Does not rebalance tree (SPLAY trees are splayed)
  */
 void insertTree( Tree *t, Data* tData )
 {
-    TNode* newNode = createTNode( );
+    TNode* newNode;
+    if( t->type==SPLAY ){
+        insertTreeSplay( t, tData );
+        return;
+    }
+    if( t->index!=NULL && searchHashIndex( t->index, tData )!=NULL )
+        return; /* key already stored, insertNode would not link newNode */
+
+    newNode = createTNode( );
     newNode->data = tData;
     t->root = insertNode( t->root, newNode );
+    if( newNode->pParent==NULL && t->root!=newNode ){
+        free( newNode ); /* key already stored */
+        return;
+    }
     updateHeights(newNode);
+    if( t->index!=NULL )
+        insertHashIndex( t->index, newNode );
 }
 
 /* insertTreeBalanced
  * input: a pointer to a Tree, a Data*
  * output: none
  *
- * Stores the passed Data* into the Tree following BST order and rebalances the tree
+ * Stores the passed Data* into the Tree following BST order and rebalances the tree (SPLAY trees are splayed)
  */
 void insertTreeBalanced( Tree *t, Data* tData )
 {
-    TNode* newNode = createTNode( );
+    TNode* newNode;
+    if( t->type==SPLAY ){
+        insertTreeSplay( t, tData );
+        return;
+    }
+    if( t->index!=NULL && searchHashIndex( t->index, tData )!=NULL )
+        return; /* key already stored, insertNode would not link newNode */
+
+    newNode = createTNode( );
     newNode->data = tData;
     t->root = insertNode( t->root, newNode );
+    if( newNode->pParent==NULL && t->root!=newNode ){
+        free( newNode ); /* key already stored */
+        return;
+    }
     updateHeights(newNode);
     rebalanceTree( t, newNode );
+    if( t->index!=NULL )
+        insertHashIndex( t->index, newNode );
 }
 
 /* removeTree
@@ -218,13 +317,17 @@ Data* removeTree( Tree *t, char* key )
     TNode *del, *update;
     TNode **parentDelPtr;
 
-    temp.key = key;
+    if( t->type==SPLAY )
+        return removeTreeSplay( t, key );
+    initData( &temp, -1, key );
     del = searchTree( t, &temp );
 
     if( del == NULL )
         return NULL;
         
     ret = del->data;
+    if( t->index!=NULL )
+        removeHashIndex( t->index, key );
 
     /* Get previous node's pointer to del */
     if( del->pParent==NULL )
@@ -255,6 +358,8 @@ Data* removeTree( Tree *t, char* key )
         TNode *next = removeNextInorder( &del->pRight );
         update = next->pParent;
         del->data = next->data;
+        if( t->index!=NULL )
+            updateHashIndex( t->index, del ); /* next's data now lives in del */
         free(next);
     }
 
@@ -264,16 +369,22 @@ Data* removeTree( Tree *t, char* key )
     return ret;
 }
 
+/* removeNextInorder
+ * input: a pointer to the link holding the root of a subtree
+ * output: the unlinked leftmost TNode of the subtree
+ *
+ * Follows the left links down to the smallest TNode and splices it out of the tree
+ */
 TNode* removeNextInorder( TNode** pRoot ){
-    TNode* temp = *pRoot;
+    TNode* temp;
 
-    if( temp->pLeft==NULL ){
-        *pRoot = temp->pRight;
-        if( temp->pRight!=NULL )
-            temp->pRight->pParent = temp->pParent;
-    }
-    else
-        temp = removeNextInorder( &temp->pLeft );
+    while( (*pRoot)->pLeft!=NULL )
+        pRoot = &(*pRoot)->pLeft;
+
+    temp = *pRoot;
+    *pRoot = temp->pRight;
+    if( temp->pRight!=NULL )
+        temp->pRight->pParent = temp->pParent;
 
     return temp;
 }
@@ -288,13 +399,14 @@ int subTreeHeight(TNode* root){
  * input: a pointer to a TNode
  * output: none
  *
- * Recursively recomputes the height of the current node and then recurses on the nodes parent
+ * Recomputes the height of the current node and then of each of its ancestors
  */
 void updateHeights(TNode* root){
-    if( root!=NULL ){
+    while( root!=NULL ){
+        STATS_INC( heightUpdates );
         root->height = subTreeHeight(root->pLeft)>subTreeHeight(root->pRight) ? subTreeHeight(root->pLeft) : subTreeHeight(root->pRight);
         root->height = root->height + 1;
-        updateHeights( root->pParent );
+        root = root->pParent;
     }
 }
 
@@ -343,6 +455,8 @@ void rebalanceTree(Tree* t, TNode* x){
 void rightRotate(Tree* t, TNode* oldRoot){
     TNode *newRoot;
 
+    STATS_INC( rotations );
+
     if( oldRoot==NULL ){
         printf("ERROR - Attempting to do a rightRotate on a NULL Root.");
         return;
@@ -379,6 +493,8 @@ void rightRotate(Tree* t, TNode* oldRoot){
 void leftRotate(Tree* t, TNode* oldRoot){
     TNode *newRoot;
 
+    STATS_INC( rotations );
+
     if( oldRoot==NULL ){
         printf("ERROR - Attempting to do a leftRotate on a NULL Root.");
         return;
@@ -424,6 +540,448 @@ int getBalance(TNode* root){
     return subTreeHeight(root->pLeft) - subTreeHeight(root->pRight);
 }
 
+/**********  Functions for the optional hash index of an AVL tree **********/
+
+/* enableHashIndex
+ * input: a pointer to an AVL or SPLAY Tree
+ * output: none
+ *
+ * Adds a hash index side-car to t holding every key currently in the tree.  From then on insertTree,
+ * insertTreeBalanced and removeTree keep it up to date and searchTree answers point lookups from it in O(1)
+ * expected time.  The tree itself still provides ordered access.  freeTree frees the index.
+ */
+void enableHashIndex( Tree* t )
+{
+    if( t->index!=NULL )
+        return;
+    t->index = createHashIndex( );
+    indexTNodes( t->index, t->root );
+}
+
+void indexTNodes( HashIndex* h, TNode* root )
+{
+    TreeIterator it;
+    TNode* x;
+
+    /* iterates rather than recursing, a SPLAY tree can be a single path as deep as it has keys */
+    initTreeIterator( &it, root );
+    while( (x = nextTreeIterator( &it ))!=NULL )
+        insertHashIndex( h, x );
+}
+
+/**********  Functions for a persistent (path-copying) AVL tree **********/
+
+/* A PERSISTENT tree is never modified in place.  insertTreePersistent and removeTreePersistent copy the
+ * O(log n) nodes on the search path (plus any nodes touched by rotations) and return a new Tree whose root
+ * shares every unchanged subtree with the old version.  Old versions therefore stay valid and can be read
+ * without locking while newer versions are built.
+ *
+ * Every TNode keeps a reference count of the parents/Trees pointing at it; freeTree drops one reference from
+ * the root and a TNode is only freed once no version uses it.  pParent is always NULL in a PERSISTENT tree
+ * (a shared node has many parents), so updateHeights only ever updates the node it is given.
+ *
+ * The Data* stored in a PERSISTENT tree is shared by every version and is NOT freed by freeTree; the caller
+ * frees it once all versions that contain it have been freed.
+ */
+
+/* snapshotTree
+ * input: a pointer to a PERSISTENT Tree
+ * output: a pointer to a new Tree (this is malloc-ed so must be freed eventually!)
+ *
+ * Returns an O(1) snapshot of t that shares all of its TNodes
+ */
+Tree* snapshotTree( Tree* t )
+{
+    Tree* snap = createTreeFromTNode( retainTNode( t->root ) );
+    snap->type = PERSISTENT;
+    return snap;
+}
+
+/* insertTreePersistent
+ * input: a pointer to a PERSISTENT Tree, a Data*
+ * output: a pointer to a new Tree (this is malloc-ed so must be freed eventually!)
+ *
+ * Returns a new balanced version of t that also stores tData.  t itself is left unchanged.
+ */
+Tree* insertTreePersistent( Tree* t, Data* tData )
+{
+    Tree* newTree = createTreeFromTNode( insertNodePersistent( t->root, tData ) );
+    newTree->type = PERSISTENT;
+    return newTree;
+}
+
+/* removeTreePersistent
+ * input: a pointer to a PERSISTENT Tree, a key, a pointer to a Data* used to return the removed data
+ * output: a pointer to a new Tree (this is malloc-ed so must be freed eventually!)
+ *
+ * Returns a new balanced version of t without the specified key.  t itself is left unchanged.
+ * *pData is set to the removed Data* (or NULL if the key was not in the tree).
+ */
+Tree* removeTreePersistent( Tree* t, char* key, Data** pData )
+{
+    Data temp;
+    Tree* newTree;
+
+    initData( &temp, -1, key );
+    *pData = NULL;
+
+    /* nothing to copy if the key isn't in the tree */
+    if( searchTree( t, &temp )==NULL )
+        return snapshotTree( t );
+
+    newTree = createTreeFromTNode( removeNodePersistent( t->root, &temp, pData ) );
+    newTree->type = PERSISTENT;
+    return newTree;
+}
+
+/* releaseTNode
+ * input: a pointer to a TNode of a PERSISTENT tree
+ * output: none
+ *
+ * Drops one reference to root and frees it (and releases its children) if no version uses it anymore
+ */
+void releaseTNode( TNode* root )
+{
+    if( root==NULL )
+        return;
+    if( __atomic_sub_fetch( &root->refCnt, 1, __ATOMIC_ACQ_REL )==0 ){
+        releaseTNode( root->pLeft );
+        releaseTNode( root->pRight );
+        free( root );
+    }
+}
+
+/* retainTNode
+ * input: a pointer to a TNode of a PERSISTENT tree
+ * output: the same pointer
+ *
+ * Adds a reference to root so it can be shared by another parent/Tree
+ */
+TNode* retainTNode( TNode* root )
+{
+    if( root!=NULL )
+        __atomic_add_fetch( &root->refCnt, 1, __ATOMIC_RELAXED );
+    return root;
+}
+
+/* ownTNode
+ * input: a reference to a TNode of a PERSISTENT tree that is held by a node we are allowed to modify
+ * output: a TNode that can be modified in place
+ *
+ * Copy-on-write: if nobody else references root it is returned as is, otherwise the reference is traded for a fresh copy
+ */
+TNode* ownTNode( TNode* root )
+{
+    TNode* copy;
+    if( __atomic_load_n( &root->refCnt, __ATOMIC_ACQUIRE )==1 )
+        return root;
+    copy = createPersistentTNode( root->data, retainTNode( root->pLeft ), retainTNode( root->pRight ) );
+    releaseTNode( root );
+    return copy;
+}
+
+/* createPersistentTNode
+ * input: a Data*, two references to TNodes
+ * output: TNode*
+ *
+ * Mallocs a new TNode that takes over the given references to its children.  Unlike attachChildNodes it never
+ * touches the children (they may be shared with other versions).
+ */
+TNode* createPersistentTNode( Data* tData, TNode* left, TNode* right )
+{
+    TNode* newNode = createTNode( );
+    newNode->data = tData;
+    newNode->pLeft = left;
+    newNode->pRight = right;
+    updateHeights( newNode );
+    return newNode;
+}
+
+/* rebalancePersistent
+ * input: a TNode we are allowed to modify
+ * output: the root of the rebalanced subtree
+ *
+ * Recomputes x's height and performs the same single/double rotations as rebalanceTree on the subtree rooted at x
+ */
+TNode* rebalancePersistent( TNode* x )
+{
+    TNode* z;
+
+    updateHeights( x );
+    if( getBalance(x) > 1 || getBalance(x) < -1 ){
+        z = getTallerSubTree( x );
+
+        if( !isSameSignBalance(x,z) ){
+            if( z==x->pLeft )
+                x->pLeft = leftRotatePersistent( ownTNode( x->pLeft ) );
+            else
+                x->pRight = rightRotatePersistent( ownTNode( x->pRight ) );
+        }
+
+        if( getBalance(x) >= 0 )
+            return rightRotatePersistent( x );
+        else
+            return leftRotatePersistent( x );
+    }
+    return x;
+}
+
+/* rightRotatePersistent and leftRotatePersistent
+ * input: a TNode we are allowed to modify
+ * output: the new root of the subtree
+ *
+ * Copy-on-write versions of rightRotate and leftRotate.  The child that moves up is copied if it is shared.
+ */
+TNode* rightRotatePersistent( TNode* oldRoot )
+{
+    TNode* newRoot = ownTNode( oldRoot->pLeft );
+
+    STATS_INC( rotations );
+
+    oldRoot->pLeft = newRoot->pRight;
+    newRoot->pRight = oldRoot;
+
+    updateHeights( oldRoot );
+    updateHeights( newRoot );
+    return newRoot;
+}
+
+TNode* leftRotatePersistent( TNode* oldRoot )
+{
+    TNode* newRoot = ownTNode( oldRoot->pRight );
+
+    STATS_INC( rotations );
+
+    oldRoot->pRight = newRoot->pLeft;
+    newRoot->pLeft = oldRoot;
+
+    updateHeights( oldRoot );
+    updateHeights( newRoot );
+    return newRoot;
+}
+
+/* insertNodePersistent
+ * input: a pointer to a TNode, a Data*
+ * output: a new reference to the root of the updated subtree
+ *
+ * Copies the path from root down to where tData belongs and rebalances the copies on the way back up
+ */
+TNode* insertNodePersistent( TNode* root, Data* tData )
+{
+    if( root==NULL )
+        return createPersistentTNode( tData, NULL, NULL );
+    if( compareData( tData, root->data ) == 0 )
+        return retainTNode( root );
+    else if( compareData( tData, root->data ) < 0 )
+        return rebalancePersistent( createPersistentTNode( root->data, insertNodePersistent( root->pLeft, tData ), retainTNode( root->pRight ) ) );
+    else /* compareData( tData, root->data ) > 0 */
+        return rebalancePersistent( createPersistentTNode( root->data, retainTNode( root->pLeft ), insertNodePersistent( root->pRight, tData ) ) );
+}
+
+/* removeNodePersistent
+ * input: a pointer to a TNode, a Data* holding the key to remove (which must be in the subtree), a pointer to a Data*
+ * output: a new reference to the root of the updated subtree
+ *
+ * Copies the path from root down to the removed node and rebalances the copies on the way back up
+ */
+TNode* removeNodePersistent( TNode* root, Data* tData, Data** pData )
+{
+    TNode* next;
+
+    if( compareData( tData, root->data ) < 0 )
+        return rebalancePersistent( createPersistentTNode( root->data, removeNodePersistent( root->pLeft, tData, pData ), retainTNode( root->pRight ) ) );
+    else if( compareData( tData, root->data ) > 0 )
+        return rebalancePersistent( createPersistentTNode( root->data, retainTNode( root->pLeft ), removeNodePersistent( root->pRight, tData, pData ) ) );
+
+    /* root holds the key */
+    *pData = root->data;
+    if( root->pLeft==NULL )
+        return retainTNode( root->pRight );
+    if( root->pRight==NULL )
+        return retainTNode( root->pLeft );
+
+    /* two children: replace with the next inorder data */
+    next = root->pRight;
+    while( next->pLeft!=NULL )
+        next = next->pLeft;
+    return rebalancePersistent( createPersistentTNode( next->data, retainTNode( root->pLeft ), removeMinPersistent( root->pRight ) ) );
+}
+
+/* removeMinPersistent
+ * input: a pointer to a TNode
+ * output: a new reference to the root of the subtree without its leftmost node
+ */
+TNode* removeMinPersistent( TNode* root )
+{
+    if( root->pLeft==NULL )
+        return retainTNode( root->pRight );
+    return rebalancePersistent( createPersistentTNode( root->data, removeMinPersistent( root->pLeft ), retainTNode( root->pRight ) ) );
+}
+
+/**********  Functions for a self-adjusting (splay) tree **********/
+
+/* searchTreeSplay
+ * input: a pointer to a SPLAY Tree, a Data* tData
+ * output: a pointer to the TNode that contains tData or, if no such node exists, NULL
+ *
+ * Splays the TNode holding tData (or the last TNode visited when tData is missing) to the root, so keys that
+ * are looked up often stay near the top and the cost of a lookup follows how popular its key is.  A hash
+ * index only saves the walk down, the TNode is still splayed.
+ */
+TNode* searchTreeSplay( Tree* t, Data* tData )
+{
+    TNode *cur = t->root, *last = NULL;
+    int cmp;
+
+    if( t->index!=NULL ){
+        cur = searchHashIndex( t->index, tData );
+        if( cur!=NULL )
+            splay( t, cur );
+        return cur;
+    }
+
+    while( cur!=NULL ){
+        last = cur;
+        cmp = compareData( tData, cur->data );
+        if( cmp == 0 )
+            break;
+        else if( cmp < 0 )
+            cur = cur->pLeft;
+        else /* cmp > 0 */
+            cur = cur->pRight;
+    }
+    if( last!=NULL )
+        splay( t, last );
+    return cur;
+}
+
+/* insertTreeSplay
+ * input: a pointer to a SPLAY Tree, a Data*
+ * output: none
+ *
+ * Stores the passed Data* following BST order and splays its TNode to the root.  If the key is already stored
+ * its TNode is splayed instead and tData is not stored.
+ */
+void insertTreeSplay( Tree* t, Data* tData )
+{
+    TNode* newNode = createTNode( );
+
+    newNode->data = tData;
+    t->root = insertNode( t->root, newNode );
+    if( newNode->pParent==NULL && t->root!=newNode ){
+        free( newNode ); /* key already stored */
+        searchTreeSplay( t, tData );
+        return;
+    }
+    splay( t, newNode );
+    if( t->index!=NULL )
+        insertHashIndex( t->index, newNode );
+}
+
+/* removeTreeSplay
+ * input: a pointer to a SPLAY Tree, a key
+ * output: the Data* with the specified key or NULL if its not in the tree
+ *
+ * Splays the key to the root, then joins its subtrees by splaying the largest key of the left subtree to the
+ * top of that subtree (where it has no right child) and hanging the right subtree there
+ */
+Data* removeTreeSplay( Tree* t, char* key )
+{
+    Data temp;
+    Data* ret;
+    TNode *del, *left, *max;
+    Tree leftTree;
+
+    initData( &temp, -1, key );
+    del = searchTreeSplay( t, &temp );
+    if( del==NULL )
+        return NULL;
+
+    ret = del->data;
+    if( t->index!=NULL )
+        removeHashIndex( t->index, key );
+
+    left = del->pLeft;
+    if( left==NULL ){
+        t->root = del->pRight;
+        if( t->root!=NULL )
+            t->root->pParent = NULL;
+    }
+    else{
+        left->pParent = NULL;
+        leftTree.root = left;
+        for( max=left; max->pRight!=NULL; max=max->pRight );
+        splay( &leftTree, max );
+        max->pRight = del->pRight;
+        if( del->pRight!=NULL )
+            del->pRight->pParent = max;
+        t->root = max;
+    }
+    free( del );
+    return ret;
+}
+
+/* splay
+ * input: a pointer to a Tree, a TNode of the tree
+ * output: none
+ *
+ * Moves x to the root with zig-zig (rotate the parent first) and zig-zag (rotate x twice) steps, which
+ * roughly halves the depth of every TNode on the path
+ */
+void splay( Tree* t, TNode* x )
+{
+    TNode *p, *g;
+
+    while( x->pParent!=NULL ){
+        p = x->pParent;
+        g = p->pParent;
+        if( g==NULL )
+            rotateUp( t, x );                   /* zig */
+        else if( (g->pLeft==p) == (p->pLeft==x) ){
+            rotateUp( t, p );                   /* zig-zig */
+            rotateUp( t, x );
+        }
+        else{
+            rotateUp( t, x );                   /* zig-zag */
+            rotateUp( t, x );
+        }
+    }
+}
+
+/* rotateUp
+ * input: a pointer to a Tree, a TNode with a parent
+ * output: none
+ *
+ * Rotates x above its parent.  Unlike rightRotate/leftRotate no heights are kept, SPLAY trees do not use them.
+ */
+void rotateUp( Tree* t, TNode* x )
+{
+    TNode *p = x->pParent, *g = p->pParent;
+
+    STATS_INC( rotations );
+    if( p->pLeft==x ){
+        p->pLeft = x->pRight;
+        if( x->pRight!=NULL )
+            x->pRight->pParent = p;
+        x->pRight = p;
+    }
+    else{
+        p->pRight = x->pLeft;
+        if( x->pLeft!=NULL )
+            x->pLeft->pParent = p;
+        x->pLeft = p;
+    }
+    p->pParent = x;
+    x->pParent = g;
+    if( g==NULL )
+        t->root = x;
+    else if( g->pLeft==p )
+        g->pLeft = x;
+    else
+        g->pRight = x;
+}
+
+
 /**********  Functions for getting Huffman Encoding **********/
 
 /* printHuffmanEncoding
@@ -479,23 +1037,182 @@ TNode* constructSegmentTree( double* points, int low, int high ){
  * Recursively inserts given line segment from segmentStart to segmentEnd into the tree
  */
 void insertSegment( TNode* root, double segmentStart, double segmentEnd ){
-    //TODO
+    STATS_INC( segmentVisits );
+    if( root==NULL || segmentEnd < root->low || segmentStart > root->high )
+        return; /* no overlap with this node's range */
+
+    if( segmentStart <= root->low && root->high <= segmentEnd ){
+        root->cnt++; /* the segment fully covers this node's range */
+        return;
+    }
 
+    insertSegment( root->pLeft, segmentStart, segmentEnd );
+    insertSegment( root->pRight, segmentStart, segmentEnd );
 }
 
 /* lineStabQuery
  * input: the root of a tree, a double queryPoint
- * output: none
+ * output: the number of line segments that contain queryPoint
  *
  * Recursively count the number of line segments which intersect the queryPoint.
  */
 int lineStabQuery( TNode* root, double queryPoint ){
-    //TODO
+    STATS_INC( segmentVisits );
+    if( root==NULL || queryPoint < root->low || queryPoint > root->high )
+        return 0;
+
+    /* every segment counted at this node covers queryPoint, the rest are counted further down */
+    return root->cnt + lineStabQuery( root->pLeft, queryPoint ) + lineStabQuery( root->pRight, queryPoint );
+}
+
+
+
+/* lineStabQueryBatch
+ * input: the root of a tree, an array of sorted query points, the number of query points, an array for the results
+ * output: none
+ *
+ * Stores lineStabQuery( root, queryPoints[i] ) in results[i] for every i using a single walk over the tree.
+ * Since the query points are sorted, the ones inside a node's range are consecutive, so each node is visited
+ * once with the count of its ancestors and the whole batch costs O(#nodes + numPoints).
+ */
+void lineStabQueryBatch( TNode* root, double* queryPoints, int numPoints, int* results ){
+    int next = 0;
+
+    /* points before or after the whole tree aren't covered by anything */
+    while( next<numPoints && (root==NULL || queryPoints[next] < root->low) )
+        results[next++] = 0;
+    if( root!=NULL )
+        lineStabQueryBatchRec( root, queryPoints, numPoints, &next, 0, results );
+    while( next<numPoints )
+        results[next++] = 0;
+}
+
+/* lineStabQueryBatchRec
+ * input: a TNode, the query points, the number of query points, the index of the next unanswered query point,
+ *        the total cnt of root's ancestors, the results array
+ * output: none
+ *
+ * Answers every unanswered query point up to root->high (none of them are below root->low)
+ */
+void lineStabQueryBatchRec( TNode* root, double* queryPoints, int numPoints, int* pNext, int cnt, int* results ){
+    STATS_INC( segmentVisits );
+    cnt += root->cnt;
+
+    if( root->pLeft==NULL || root->pRight==NULL ){
+        while( *pNext<numPoints && queryPoints[*pNext] <= root->high )
+            results[(*pNext)++] = cnt;
+        return;
+    }
+
+    lineStabQueryBatchRec( root->pLeft, queryPoints, numPoints, pNext, cnt, results );
+    /* points in the gap between the two children only get the counts down to this node */
+    while( *pNext<numPoints && queryPoints[*pNext] < root->pRight->low )
+        results[(*pNext)++] = cnt;
+    lineStabQueryBatchRec( root->pRight, queryPoints, numPoints, pNext, cnt, results );
+}
 
-    return -1;
+/**********  Functions for iterating over a tree in order **********/
+
+/* initTreeIterator and nextTreeIterator
+ * input: a pointer to a TreeIterator (usually a local variable), the root of a subtree
+ * output: the next TNode in order or NULL once every TNode of the subtree has been returned
+ *
+ * Walks the subtree in order using the parent pointers, so no memory is allocated and any depth is supported.
+ * The tree must not be changed while it is being iterated.  Not valid for PERSISTENT trees (no parent pointers).
+ */
+void initTreeIterator( TreeIterator* it, TNode* root ){
+    it->root = root;
+    it->next = root;
+    if( root!=NULL ){
+        while( it->next->pLeft!=NULL )
+            it->next = it->next->pLeft;
+    }
+}
+
+TNode* nextTreeIterator( TreeIterator* it ){
+    TNode *cur = it->next, *x;
+
+    if( cur==NULL )
+        return NULL;
+
+    if( cur->pRight!=NULL ){
+        /* the leftmost TNode of the right subtree */
+        x = cur->pRight;
+        while( x->pLeft!=NULL )
+            x = x->pLeft;
+        it->next = x;
+    }
+    else{
+        /* climb until we come up from a left child (or leave the subtree) */
+        x = cur;
+        while( x!=it->root && x->pParent->pRight==x )
+            x = x->pParent;
+        it->next = x==it->root ? NULL : x->pParent;
+    }
+    return cur;
+}
+
+/**********  Functions for measuring the memory of a tree **********/
+
+/* memoryUsageTree
+ * input: a pointer to a Tree
+ * output: the bytes used by the Tree, its TNodes, its hash index and the Data/str buffers the TNodes own
+ *
+ * A PERSISTENT tree counts every TNode reachable from its root, including TNodes shared with other versions.
+ */
+MemoryUsage memoryUsageTree( Tree* t ){
+    MemoryUsage mu = memoryUsageTNodes( t->root, t->type ), index;
+
+    addNodeMemory( &mu, t, sizeof(Tree) );
+    if( t->index!=NULL ){
+        index = memoryUsageHashIndex( t->index );
+        index.numElements = 0; /* the keys were counted with their TNodes */
+        addMemoryUsage( &mu, &index );
+    }
+    return mu;
 }
 
+/* memoryUsageTNodes
+ * input: the root of a subtree, the type of tree it belongs to
+ * output: the bytes used by the TNodes of the subtree and the Data/str buffers they own
+ *
+ * AVL and PERSISTENT TNodes own their Data and its key, HUFFMAN TNodes own their str.  Uses an explicit stack so
+ * a degenerate tree is fine.
+ */
+MemoryUsage memoryUsageTNodes( TNode* root, treeType type ){
+    int top = 0, capacity = 64;
+    TNode** stack;
+    TNode* x;
+    MemoryUsage mu;
 
+    resetMemoryUsage( &mu );
+    if( root==NULL )
+        return mu;
+    stack = (TNode**)malloc( capacity*sizeof(TNode*) );
+    stack[top++] = root;
+    while( top>0 ){
+        x = stack[--top];
+        mu.numElements++;
+        addNodeMemory( &mu, x, sizeof(TNode) );
+        if( (type==AVL || type==PERSISTENT || type==SPLAY) && x->data!=NULL ){
+            addPayloadMemory( &mu, x->data, sizeof(Data) );
+            addKeyMemory( &mu, x->data );
+        }
+        if( type==HUFFMAN )
+            addStringMemory( &mu, x->str );
+
+        if( top+2 > capacity ){
+            capacity *= 2;
+            stack = (TNode**)realloc( stack, capacity*sizeof(TNode*) );
+        }
+        if( x->pRight!=NULL )
+            stack[top++] = x->pRight;
+        if( x->pLeft!=NULL )
+            stack[top++] = x->pLeft;
+    }
+    free( stack );
+    return mu;
+}
 
 /**********  Functions for debugging an AVL tree **********/
 
@@ -507,14 +1224,15 @@ int lineStabQuery( TNode* root, double queryPoint ){
  */
 void printTree( TNode* root ){
     int i;
-    if(root!=NULL){
-        printTree(root->pLeft);
-        for( i=1; i<root->height; i++){
+    TreeIterator it;
+    TNode* x;
+
+    initTreeIterator( &it, root );
+    while( (x = nextTreeIterator( &it ))!=NULL ){
+        for( i=1; i<x->height; i++){
             printf("\t");
         }
-        printf("%s\n",root->data->key);
-        printTree(root->pRight);
-
+        printf("%s\n",x->data->key);
     }
 }
 
@@ -525,17 +1243,35 @@ void printTree( TNode* root ){
  * Prints error messages if there are any problems with the AVL tree
  */
 void checkAVLTree(TNode* root){
-    if( root!=NULL ){
-        if( getBalance(root)>1 ||  getBalance(root)<-1 )
-            printf("ERROR - Node %s had balance %d\n",root->data->key,getBalance(root) );
-        if( root->pLeft!=NULL && root->pLeft->pParent!=root )
-            printf("ERROR - Invalid edge at %s-%s\n",root->data->key,root->pLeft->data->key );
-        if( root->pRight!=NULL && root->pRight->pParent!=root )
-            printf("ERROR - Invalid edge at %s-%s\n",root->data->key,root->pRight->data->key );
+    /* uses an explicit stack rather than the parent pointers, since those are part of what is being checked */
+    int top = 0, capacity = 64;
+    TNode** stack;
+    TNode* x;
 
-        checkAVLTree(root->pLeft);
-        checkAVLTree(root->pRight);
+    if( root==NULL )
+        return;
+    stack = (TNode**)malloc( capacity*sizeof(TNode*) );
+    stack[top++] = root;
+    while( top>0 ){
+        x = stack[--top];
+        if( getBalance(x)>1 ||  getBalance(x)<-1 )
+            printf("ERROR - Node %s had balance %d\n",x->data->key,getBalance(x) );
+        if( x->pLeft!=NULL && x->pLeft->pParent!=x )
+            printf("ERROR - Invalid edge at %s-%s\n",x->data->key,x->pLeft->data->key );
+        if( x->pRight!=NULL && x->pRight->pParent!=x )
+            printf("ERROR - Invalid edge at %s-%s\n",x->data->key,x->pRight->data->key );
+
+        if( top+2 > capacity ){
+            capacity *= 2;
+            stack = (TNode**)realloc( stack, capacity*sizeof(TNode*) );
+        }
+        /* push right first so the left subtree is checked first */
+        if( x->pRight!=NULL )
+            stack[top++] = x->pRight;
+        if( x->pLeft!=NULL )
+            stack[top++] = x->pLeft;
     }
+    free( stack );
 }
 
 /**********  Functions for printing a tree **********/
@@ -565,7 +1301,7 @@ void printTreeByType( Tree* t, TNode* root, int depth ){
         else
             printf("/");
 
-        if( t->type == AVL ){ 
+        if( t->type == AVL || t->type == SPLAY ){ 
             /* For better readability sets the index 7 to a '+' when printing non-leaf nodes */
             root->data->key[7] = c;
             printf("%s\n",root->data->key);
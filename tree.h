@@ -6,10 +6,11 @@
 #include <string.h>
 
 #include "data.h"
+#include "memoryUsage.h"
 
 typedef struct Data Data;
 
-typedef enum treeType{ HUFFMAN, AVL, SEGMENT } treeType;
+typedef enum treeType{ HUFFMAN, AVL, SEGMENT, PERSISTENT, SPLAY } treeType;
 
 typedef struct TNode
 {
@@ -29,14 +30,24 @@ typedef struct TNode
     /* Segment tree data */
     double low, high;       /* the line segment specified by this TNode is from low to high */
     int cnt;                /* the number of inserted line segments that FULLY cover the range (low,high) but not the range of an ancestor of this TNode */
+
+    /* Persistent AVL data */
+    int refCnt;             /* number of parents/Trees sharing this TNode (only maintained for PERSISTENT trees) */
 }  TNode;
 
 typedef struct Tree
 {
     TNode* root;            /* the root of this tree (it will be a NULL if the tree is empty) */
     treeType type;          /* the type of data that the TNodes stored in this tree will have (e.g. HUFFMAN, AVL, SEGMENT) */
+    struct HashIndex* index;/* optional hash index from key to TNode for AVL trees (NULL if not enabled) */
 }  Tree;
 
+typedef struct TreeIterator
+{
+    TNode* root;            /* root of the subtree being iterated */
+    TNode* next;            /* the next TNode to return (NULL once the iteration is finished) */
+}  TreeIterator;
+
 /**********  Functions for creating/freeing a tree **********/
 Tree *createTree( );
 Tree *createTreeFromTNode( TNode* root );
@@ -57,6 +68,20 @@ void insertTree( Tree* t, Data* tData );
 void insertTreeBalanced( Tree* t, Data* tData );
 Data* removeTree( Tree* t, char* key );
 
+/**********  Functions for the optional hash index of an AVL tree **********/
+void enableHashIndex( Tree* t );
+
+/**********  Functions for a persistent (path-copying) AVL tree **********/
+Tree* snapshotTree( Tree* t );
+Tree* insertTreePersistent( Tree* t, Data* tData );
+Tree* removeTreePersistent( Tree* t, char* key, Data** pData );
+void releaseTNode( TNode* root );
+
+/**********  Functions for a self-adjusting (splay) tree **********/
+TNode* searchTreeSplay( Tree* t, Data* tData );
+void insertTreeSplay( Tree* t, Data* tData );
+Data* removeTreeSplay( Tree* t, char* key );
+
 /**********  Functions for getting Huffman Encoding **********/
 void printHuffmanEncoding( TNode* root, char c );
 
@@ -64,6 +89,15 @@ void printHuffmanEncoding( TNode* root, char c );
 TNode* constructSegmentTree( double* points, int low, int high);
 void insertSegment( TNode* root, double segmentStart, double segmentEnd );
 int lineStabQuery( TNode* root, double queryPoint );
+void lineStabQueryBatch( TNode* root, double* queryPoints, int numPoints, int* results );
+
+/**********  Functions for iterating over a tree in order **********/
+void initTreeIterator( TreeIterator* it, TNode* root );
+TNode* nextTreeIterator( TreeIterator* it );
+
+/**********  Functions for measuring the memory of a tree **********/
+MemoryUsage memoryUsageTree( Tree* t );
+MemoryUsage memoryUsageTNodes( TNode* root, treeType type );
 
 /**********  Functions for debugging an AVL tree **********/
 void printTree( TNode* root );
@@ -0,0 +1,446 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "treeSnapshot.h"
+#include "moveFile.h"
+
+/*
+ * offset stored for a HUFFMAN TNode without a str
+ */
+uint64_t const SNAPSHOT_NO_STRING = UINT64_MAX;
+
+/**********  Helper functions for writing a snapshot **********/
+long countSnapshotNodes( TNode* root, treeType type, long* pStringBytes );
+void fillKeyColumns( TNode* root, char* columns, long numNodes, char* strings, long* pNext, long* pStringPos );
+void fillPreorderColumns( TNode* root, treeType type, char* columns, long numNodes, char* strings, long* pNext, long* pStringPos );
+size_t snapshotColumnBytes( treeType type, long numNodes );
+
+/**********  Helper functions for reading a snapshot **********/
+TNode* loadKeyRange( TreeSnapshot* ts, int low, int high, TNode* parent );
+TNode* loadPreorder( TreeSnapshot* ts, int* pNext, TNode* parent );
+char* snapshotString( TreeSnapshot* ts, uint64_t offset );
+int loadedHeight( TNode* root );
+void invalidSnapshot( char* reason );
+
+/**********  Functions for writing a snapshot **********/
+
+/* writeTreeSnapshot
+ * input: the name of the file to write, a pointer to an AVL, PERSISTENT, SPLAY, SEGMENT or HUFFMAN Tree
+ * output: none
+ *
+ * Writes t in the snapshot format described in treeSnapshot.h.  An AVL tree is written as its keys in order,
+ * so it can be reloaded without a single compare or rotation.  The hash index (if any) is not written.
+ */
+void writeTreeSnapshot( char* fileName, Tree* t )
+{
+    char header[TREE_SNAPSHOT_HEADER_SIZE];
+    long stringBytes = 0, next = 0, stringPos = 0;
+    long numNodes = countSnapshotNodes( t->root, t->type, &stringBytes );
+    size_t columnBytes = snapshotColumnBytes( t->type, numNodes );
+    char* columns = (char*)calloc( columnBytes+1, sizeof(char) ); /* calloc zeroes the HUFFMAN padding */
+    char* strings = (char*)malloc( (stringBytes+1)*sizeof(char) );
+    FILE* out = fopen( fileName, "wb" );
+
+    if( out==NULL ){
+        printf("File %s could not be created.\n", fileName);
+        exit(-1);
+    }
+
+    if( t->type==AVL || t->type==PERSISTENT || t->type==SPLAY )
+        fillKeyColumns( t->root, columns, numNodes, strings, &next, &stringPos );
+    else
+        fillPreorderColumns( t->root, t->type, columns, numNodes, strings, &next, &stringPos );
+
+    memcpy( header, TREE_SNAPSHOT_MAGIC, 8 );
+    writeLittleEndian64( header+8, (uint64_t)t->type ); /* the uint32 type followed by a uint32 zero */
+    writeLittleEndian64( header+16, (uint64_t)numNodes );
+    writeLittleEndian64( header+24, (uint64_t)stringBytes );
+    if( fwrite( header, 1, TREE_SNAPSHOT_HEADER_SIZE, out )!=TREE_SNAPSHOT_HEADER_SIZE
+        || fwrite( columns, 1, columnBytes, out )!=columnBytes
+        || fwrite( strings, 1, stringBytes, out )!=(size_t)stringBytes
+        || fclose( out )!=0 ){
+        printf("File %s could not be written.\n", fileName);
+        exit(-1);
+    }
+
+    free( columns );
+    free( strings );
+}
+
+/* countSnapshotNodes
+ * input: a pointer to a TNode, the type of its tree, the string bytes counted so far
+ * output: the number of TNodes in the subtree (the string bytes of the subtree are added to *pStringBytes)
+ *
+ * Uses an explicit stack since a SPLAY tree can be a single path as deep as it has keys
+ */
+long countSnapshotNodes( TNode* root, treeType type, long* pStringBytes )
+{
+    long numNodes = 0, top = 0, capacity = 64;
+    TNode** stack;
+    TNode* x;
+
+    if( root==NULL )
+        return 0;
+    stack = (TNode**)malloc( capacity*sizeof(TNode*) );
+    stack[top++] = root;
+    while( top>0 ){
+        x = stack[--top];
+        numNodes++;
+        if( type==AVL || type==PERSISTENT || type==SPLAY )
+            *pStringBytes += strlen( x->data->key )+1;
+        else if( type==HUFFMAN && x->str!=NULL )
+            *pStringBytes += strlen( x->str )+1;
+
+        if( top+2 > capacity ){
+            capacity *= 2;
+            stack = (TNode**)realloc( stack, capacity*sizeof(TNode*) );
+        }
+        if( x->pRight!=NULL )
+            stack[top++] = x->pRight;
+        if( x->pLeft!=NULL )
+            stack[top++] = x->pLeft;
+    }
+    free( stack );
+    return numNodes;
+}
+
+/* fillKeyColumns
+ * input: a pointer to a TNode, the columns, the number of keys, the string section, the next key and string
+ *        positions
+ * output: none
+ *
+ * Stores the keys of the subtree in order.  The walk keeps its own stack (PERSISTENT TNodes have no parent
+ * pointers for a TreeIterator, and a SPLAY tree can be too deep to recurse over).
+ */
+void fillKeyColumns( TNode* root, char* columns, long numNodes, char* strings, long* pNext, long* pStringPos )
+{
+    long top = 0, capacity = 64;
+    TNode** stack = (TNode**)malloc( capacity*sizeof(TNode*) );
+    TNode* x = root;
+    size_t length;
+
+    while( x!=NULL || top>0 ){
+        for( ; x!=NULL; x=x->pLeft ){
+            if( top==capacity ){
+                capacity *= 2;
+                stack = (TNode**)realloc( stack, capacity*sizeof(TNode*) );
+            }
+            stack[top++] = x;
+        }
+        x = stack[--top];
+
+        length = strlen( x->data->key )+1;
+        memcpy( strings + *pStringPos, x->data->key, length );
+        writeLittleEndian64( columns + 8*(*pNext), (uint64_t)*pStringPos );
+        writeLittleEndian64( columns + 8*(numNodes + *pNext), (uint64_t)(int64_t)x->data->verification );
+        *pStringPos += length;
+        (*pNext)++;
+
+        x = x->pRight;
+    }
+    free( stack );
+}
+
+/* fillPreorderColumns
+ * input: a pointer to a TNode, the type of its tree, the columns, the number of TNodes, the string section, the
+ *        next TNode and string positions
+ * output: none
+ *
+ * Stores the TNodes of the subtree in preorder along with which children each one has
+ */
+void fillPreorderColumns( TNode* root, treeType type, char* columns, long numNodes, char* strings, long* pNext, long* pStringPos )
+{
+    long i = (*pNext)++;
+    size_t length;
+    uint64_t bits;
+    char* children;
+
+    if( type==SEGMENT ){
+        memcpy( &bits, &root->low, 8 );
+        writeLittleEndian64( columns + 8*i, bits );
+        memcpy( &bits, &root->high, 8 );
+        writeLittleEndian64( columns + 8*(numNodes + i), bits );
+        writeLittleEndian64( columns + 8*(2*numNodes + i), (uint64_t)(int64_t)root->cnt );
+        children = columns + 24*numNodes;
+    }
+    else{
+        if( root->str==NULL )
+            writeLittleEndian64( columns + 8*i, SNAPSHOT_NO_STRING );
+        else{
+            length = strlen( root->str )+1;
+            memcpy( strings + *pStringPos, root->str, length );
+            writeLittleEndian64( columns + 8*i, (uint64_t)*pStringPos );
+            *pStringPos += length;
+        }
+        writeLittleEndian64( columns + 8*(numNodes + i), (uint64_t)(int64_t)root->priority );
+        children = columns + 16*numNodes;
+    }
+    children[i] = (root->pLeft!=NULL) | (root->pRight!=NULL)<<1;
+
+    if( root->pLeft!=NULL )
+        fillPreorderColumns( root->pLeft, type, columns, numNodes, strings, pNext, pStringPos );
+    if( root->pRight!=NULL )
+        fillPreorderColumns( root->pRight, type, columns, numNodes, strings, pNext, pStringPos );
+}
+
+/* snapshotColumnBytes
+ * input: the type of a tree, its number of keys or TNodes
+ * output: the size of the columns between the header and the string section
+ */
+size_t snapshotColumnBytes( treeType type, long numNodes )
+{
+    if( type==SEGMENT )
+        return 25*(size_t)numNodes;
+    if( type==HUFFMAN )
+        return (17*(size_t)numNodes + 7) & ~(size_t)7; /* keeps the strings 8-byte aligned */
+    return 16*(size_t)numNodes;
+}
+
+/**********  Functions for reading a snapshot **********/
+
+/* openTreeSnapshot
+ * input: the name of a snapshot file
+ * output: a pointer to a TreeSnapshot (this is malloc-ed so must be freed eventually with closeTreeSnapshot!)
+ *
+ * Maps the file and checks its header against its size.  Nothing is copied until the snapshot is loaded or
+ * frozen.
+ */
+TreeSnapshot* openTreeSnapshot( char* fileName )
+{
+    TreeSnapshot* ts;
+    struct stat st;
+    const char* header;
+    uint64_t type;
+    int64_t numNodes, stringBytes;
+    size_t columnBytes;
+    int fd = open( fileName, O_RDONLY );
+
+    if( fd<0 ){
+        printf("File %s not found.\n", fileName);
+        exit(-1);
+    }
+    if( fstat( fd, &st )!=0 || st.st_size < TREE_SNAPSHOT_HEADER_SIZE )
+        invalidSnapshot( "the file is shorter than the header" );
+
+    ts = (TreeSnapshot*)malloc( sizeof(TreeSnapshot) );
+    ts->mappingSize = st.st_size;
+    ts->mapping = mmap( NULL, ts->mappingSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( ts->mapping==MAP_FAILED ){
+        printf("File %s could not be mapped.\n", fileName);
+        exit(-1);
+    }
+    madvise( ts->mapping, ts->mappingSize, MADV_WILLNEED );
+
+    header = (const char*)ts->mapping;
+    if( memcmp( header, TREE_SNAPSHOT_MAGIC, 8 )!=0 )
+        invalidSnapshot( "it does not start with " TREE_SNAPSHOT_MAGIC );
+    type = readLittleEndian64( header+8 );
+    numNodes = (int64_t)readLittleEndian64( header+16 );
+    stringBytes = (int64_t)readLittleEndian64( header+24 );
+    if( type!=AVL && type!=PERSISTENT && type!=SEGMENT && type!=HUFFMAN && type!=SPLAY )
+        invalidSnapshot( "the tree type is unknown" );
+    if( numNodes<0 || numNodes>INT32_MAX || stringBytes<0 )
+        invalidSnapshot( "the header is corrupt" );
+
+    columnBytes = snapshotColumnBytes( (treeType)type, numNodes );
+    if( ts->mappingSize - TREE_SNAPSHOT_HEADER_SIZE < columnBytes
+        || ts->mappingSize - TREE_SNAPSHOT_HEADER_SIZE - columnBytes < (uint64_t)stringBytes )
+        invalidSnapshot( "the header does not match the size of the file" );
+
+    ts->type = (treeType)type;
+    ts->numNodes = (int)numNodes;
+    ts->columns = header + TREE_SNAPSHOT_HEADER_SIZE;
+    ts->strings = ts->columns + columnBytes;
+    ts->stringBytes = stringBytes;
+    ts->data = NULL;
+    ts->keys = NULL;
+    /* every offset is checked to be inside the string section, so a NUL at its end keeps strlen inside it */
+    if( ts->stringBytes>0 && ts->strings[ts->stringBytes-1]!='\0' )
+        invalidSnapshot( "the strings are not NUL-terminated" );
+
+    return ts;
+}
+
+/* closeTreeSnapshot
+ * input: a pointer to a TreeSnapshot
+ * output: none
+ *
+ * Unmaps the file.  Trees returned by loadTreeSnapshot are independent copies and stay valid, FrozenTrees
+ * returned by freezeTreeSnapshot must be freed first.
+ */
+void closeTreeSnapshot( TreeSnapshot* ts )
+{
+    free( ts->data );
+    munmap( ts->mapping, ts->mappingSize );
+    free( ts );
+}
+
+/* loadTreeSnapshot
+ * input: a pointer to a TreeSnapshot
+ * output: a pointer to a Tree (this is malloc-ed so must be freed eventually!)
+ *
+ * Bulk loads the snapshot in O(n).  The sorted keys of an AVL or PERSISTENT snapshot become a perfectly
+ * balanced tree (split at the middle key), so nothing is compared or rotated.  SEGMENT and HUFFMAN TNodes are
+ * rebuilt from the preorder.  The Tree owns copies of the keys/strs, so the snapshot can be closed right away.
+ * When ts->keys is set the keys are interned there instead, so trees loaded from several snapshots share them.
+ */
+Tree* loadTreeSnapshot( TreeSnapshot* ts )
+{
+    Tree* t = createTree( );
+    int next = 0;
+
+    t->type = ts->type;
+    if( ts->numNodes==0 )
+        return t;
+    if( ts->type==AVL || ts->type==PERSISTENT || ts->type==SPLAY )
+        t->root = loadKeyRange( ts, 0, ts->numNodes-1, NULL );
+    else{
+        t->root = loadPreorder( ts, &next, NULL );
+        if( next!=ts->numNodes )
+            invalidSnapshot( "the preorder does not cover every TNode" );
+    }
+    return t;
+}
+
+/* freezeTreeSnapshot
+ * input: a pointer to an AVL or PERSISTENT TreeSnapshot
+ * output: a pointer to a FrozenTree (this is malloc-ed so must be freed eventually!)
+ *
+ * Lays the keys out in Eytzinger order in O(n) without copying them: the keys of the FrozenTree point into the
+ * mapping, so the snapshot must outlive the FrozenTree.
+ */
+FrozenTree* freezeTreeSnapshot( TreeSnapshot* ts )
+{
+    FrozenTree* ft;
+    Data** sorted;
+    int i;
+
+    if( ts->type!=AVL && ts->type!=PERSISTENT && ts->type!=SPLAY ){
+        printf( "Only AVL, PERSISTENT and SPLAY snapshots can be frozen.\n" );
+        exit(-1);
+    }
+    if( ts->data==NULL ){
+        ts->data = (Data*)malloc( (ts->numNodes+1)*sizeof(Data) );
+        for( i=0; i<ts->numNodes; i++ ){
+            /* the key lives in the mapping, these Data are never freed with freeData */
+            initData( &ts->data[i], (int)(int64_t)readLittleEndian64( ts->columns + 8*((long)ts->numNodes + i) ),
+                      snapshotString( ts, readLittleEndian64( ts->columns + 8*(long)i ) ) );
+        }
+    }
+
+    sorted = (Data**)malloc( (ts->numNodes+1)*sizeof(Data*) );
+    for( i=0; i<ts->numNodes; i++ )
+        sorted[i] = &ts->data[i];
+    ft = freezeSortedData( sorted, ts->numNodes );
+    free( sorted );
+    return ft;
+}
+
+/* loadKeyRange
+ * input: a pointer to a TreeSnapshot, the range of keys to load, the parent of the subtree
+ * output: the root of a balanced subtree holding keys low..high
+ */
+TNode* loadKeyRange( TreeSnapshot* ts, int low, int high, TNode* parent )
+{
+    int mid = low + (high-low)/2;
+    TNode* root;
+    char* key;
+    size_t length;
+
+    if( low>high )
+        return NULL;
+
+    root = createTNode( );
+    root->pParent = parent;
+    key = snapshotString( ts, readLittleEndian64( ts->columns + 8*(long)mid ) );
+    root->data = createData( (int)(int64_t)readLittleEndian64( ts->columns + 8*((long)ts->numNodes + mid) ), NULL );
+    if( ts->keys!=NULL ){
+        root->data->key = internKey( ts->keys, key );
+        root->data->internedKey = true;
+    }
+    else{
+        length = strlen( key )+1;
+        root->data->key = (char*)malloc( length*sizeof(char) );
+        memcpy( root->data->key, key, length );
+    }
+
+    root->pLeft = loadKeyRange( ts, low, mid-1, root );
+    root->pRight = loadKeyRange( ts, mid+1, high, root );
+    root->height = loadedHeight( root );
+    return root;
+}
+
+/* loadPreorder
+ * input: a pointer to a TreeSnapshot, the index of the next TNode in preorder, the parent of the subtree
+ * output: the root of the subtree that starts at TNode *pNext
+ */
+TNode* loadPreorder( TreeSnapshot* ts, int* pNext, TNode* parent )
+{
+    long n = ts->numNodes, i = *pNext;
+    unsigned char children;
+    uint64_t bits;
+    char* str;
+    TNode* root;
+
+    if( i>=n )
+        invalidSnapshot( "the preorder runs past the last TNode" );
+    (*pNext)++;
+
+    root = createTNode( );
+    root->pParent = parent;
+    if( ts->type==SEGMENT ){
+        bits = readLittleEndian64( ts->columns + 8*i );
+        memcpy( &root->low, &bits, 8 );
+        bits = readLittleEndian64( ts->columns + 8*(n + i) );
+        memcpy( &root->high, &bits, 8 );
+        root->cnt = (int)(int64_t)readLittleEndian64( ts->columns + 8*(2*n + i) );
+        children = (unsigned char)ts->columns[24*n + i];
+    }
+    else{
+        bits = readLittleEndian64( ts->columns + 8*i );
+        root->str = NULL;
+        if( bits!=SNAPSHOT_NO_STRING ){
+            str = snapshotString( ts, bits );
+            root->str = (char*)malloc( (strlen( str )+1)*sizeof(char) );
+            strcpy( root->str, str );
+        }
+        root->priority = (int)(int64_t)readLittleEndian64( ts->columns + 8*(n + i) );
+        children = (unsigned char)ts->columns[16*n + i];
+    }
+
+    root->pLeft = (children & 1) ? loadPreorder( ts, pNext, root ) : NULL;
+    root->pRight = (children & 2) ? loadPreorder( ts, pNext, root ) : NULL;
+    root->height = loadedHeight( root );
+    return root;
+}
+
+/* snapshotString
+ * input: a pointer to a TreeSnapshot, an offset into its string section
+ * output: the NUL-terminated string at that offset (inside the mapping)
+ */
+char* snapshotString( TreeSnapshot* ts, uint64_t offset )
+{
+    if( offset>=ts->stringBytes )
+        invalidSnapshot( "a string offset is past the string section" );
+    return (char*)ts->strings + offset;
+}
+
+/* loadedHeight
+ * input: a TNode whose children are loaded
+ * output: the height of the TNode
+ */
+int loadedHeight( TNode* root )
+{
+    int left = root->pLeft==NULL ? 0 : root->pLeft->height;
+    int right = root->pRight==NULL ? 0 : root->pRight->height;
+    return (left>right ? left : right) + 1;
+}
+
+void invalidSnapshot( char* reason )
+{
+    printf( "Invalid tree snapshot: %s.\n", reason );
+    exit(-1);
+}
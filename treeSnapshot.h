@@ -0,0 +1,46 @@
+#ifndef _treeSnapshot_h
+#define _treeSnapshot_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "tree.h"
+#include "frozenTree.h"
+#include "keyIntern.h"
+
+#define TREE_SNAPSHOT_MAGIC "CTPTREE1"  /* first 8 bytes of a tree snapshot */
+#define TREE_SNAPSHOT_HEADER_SIZE 32    /* magic, uint32 type, uint32 zero, int64 number of nodes, int64 bytes of strings */
+
+/* A snapshot is little-endian and every column is 8-byte aligned:
+ *   AVL, PERSISTENT, SPLAY  the keys in increasing order: uint64 key offset[n], int64 verification[n], then the keys
+ *   SEGMENT                 the TNodes in preorder: double low[n], double high[n], int64 cnt[n], uint8 children[n]
+ *   HUFFMAN                 the TNodes in preorder: uint64 str offset[n] (all ones for no str), int64 priority[n],
+ *                           uint8 children[n] padded to 8 bytes, then the strs
+ * children has bit 0 set for a left child and bit 1 set for a right child.  Strings are NUL-terminated and
+ * their offsets are from the start of the string section.
+ */
+typedef struct TreeSnapshot
+{
+    treeType type;          /* type of the tree that was written */
+    int numNodes;           /* number of keys (AVL, PERSISTENT, SPLAY) or TNodes (SEGMENT, HUFFMAN) */
+    const char* columns;    /* the per-node columns (right after the header) */
+    const char* strings;    /* the string section */
+    size_t stringBytes;     /* size of the string section */
+    Data* data;             /* Data for every key with the key pointing into the mapping (made by freezeTreeSnapshot) */
+    KeyTable* keys;         /* table loadTreeSnapshot interns the keys into (NULL to malloc every key) */
+    void* mapping;          /* the mmap-ed file */
+    size_t mappingSize;     /* size of the mapping in bytes */
+}  TreeSnapshot;
+
+/**********  Functions for writing a snapshot **********/
+void writeTreeSnapshot( char* fileName, Tree* t );
+
+/**********  Functions for reading a snapshot **********/
+TreeSnapshot* openTreeSnapshot( char* fileName );
+void closeTreeSnapshot( TreeSnapshot* ts );
+Tree* loadTreeSnapshot( TreeSnapshot* ts );
+FrozenTree* freezeTreeSnapshot( TreeSnapshot* ts );
+
+#endif
@@ -0,0 +1,188 @@
+#include <math.h>
+
+#include "workload.h"
+
+/* nextRandom
+ * input: a pointer to the generator state
+ * output: the next 64 random bits
+ *
+ * splitmix64: unlike rand() it has 64 bits of output (RAND_MAX can be as small as 32767) and every seed gives
+ * the same stream on every platform
+ */
+uint64_t nextRandom( uint64_t* state )
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* nextUniform
+ * input: a pointer to the generator state
+ * output: a double uniformly distributed in [0,1)
+ */
+double nextUniform( uint64_t* state )
+{
+    return (nextRandom( state ) >> 11) * (1.0/9007199254740992.0);
+}
+
+/* generateKeyOrder
+ * input: the number of keys, the order, a seed
+ * output: an array with each of 0..numKeys-1 once (this is malloc-ed so must be freed eventually!)
+ *
+ * RANDOM_ORDER is a uniform shuffle, SEQUENTIAL_ORDER and REVERSE_ORDER are sorted.  SKEWED_ORDER is nearly
+ * sorted: blocks of 64 consecutive keys are shuffled, so inserts keep landing at the right edge of the tree.
+ */
+int* generateKeyOrder( int numKeys, keyOrder order, uint64_t seed )
+{
+    int* keys = (int*)malloc( numKeys*sizeof(int) );
+    int i, j, tmp, blockStart;
+
+    for( i=0; i<numKeys; i++ )
+        keys[i] = order==REVERSE_ORDER ? numKeys-1-i : i;
+
+    if( order==RANDOM_ORDER ){
+        for( i=numKeys-1; i>0; i-- ){
+            j = nextRandom( &seed ) % (i+1);
+            tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+    }
+    else if( order==SKEWED_ORDER ){
+        for( i=numKeys-1; i>0; i-- ){
+            blockStart = i - i%64;
+            j = blockStart + nextRandom( &seed ) % (i-blockStart+1);
+            tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+    }
+    return keys;
+}
+
+/* parseKeyOrder
+ * input: "random", "sequential", "reverse" or "skewed", a pointer for the order
+ * output: true if the name was recognized
+ */
+bool parseKeyOrder( char* name, keyOrder* pOrder )
+{
+    keyOrder order;
+
+    for( order=RANDOM_ORDER; order<=SKEWED_ORDER; order++ ){
+        if( strcmp( name, keyOrderName( order ) )==0 ){
+            *pOrder = order;
+            return true;
+        }
+    }
+    return false;
+}
+
+char* keyOrderName( keyOrder order )
+{
+    switch( order ){
+        case RANDOM_ORDER: return "random";
+        case SEQUENTIAL_ORDER: return "sequential";
+        case REVERSE_ORDER: return "reverse";
+        default: return "skewed";
+    }
+}
+
+/* createZipfGenerator
+ * input: the number of symbols, the exponent, a seed
+ * output: a pointer to a ZipfGenerator (this is malloc-ed so must be freed eventually!)
+ *
+ * Up to ZIPF_TABLE_MAX symbols the exact CDF is tabulated and searched.  Above that a table would be too big
+ * (10^8 keys would need 800MB), so symbols come from inverting the continuous power law instead.
+ */
+ZipfGenerator* createZipfGenerator( int numSymbols, double exponent, uint64_t seed )
+{
+    ZipfGenerator* z = (ZipfGenerator*)malloc( sizeof(ZipfGenerator) );
+    double sum = 0;
+    int k;
+
+    z->numSymbols = numSymbols;
+    z->exponent = exponent;
+    z->state = seed;
+    z->cdf = NULL;
+    if( numSymbols <= ZIPF_TABLE_MAX ){
+        z->cdf = (double*)malloc( numSymbols*sizeof(double) );
+        for( k=0; k<numSymbols; k++ ){
+            sum += 1.0/pow( k+1, exponent );
+            z->cdf[k] = sum;
+        }
+        for( k=0; k<numSymbols; k++ )
+            z->cdf[k] /= sum;
+    }
+    return z;
+}
+
+void freeZipfGenerator( ZipfGenerator* z )
+{
+    free( z->cdf );
+    free( z );
+}
+
+/* nextZipf
+ * input: a ZipfGenerator
+ * output: the next symbol
+ */
+int nextZipf( ZipfGenerator* z )
+{
+    double u = nextUniform( &z->state );
+    double n = z->numSymbols, x;
+    int low = 0, high = z->numSymbols-1, mid;
+
+    if( z->cdf!=NULL ){
+        /* first symbol whose cumulative probability exceeds u */
+        while( low < high ){
+            mid = (low+high)/2;
+            if( z->cdf[mid] <= u )
+                low = mid+1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    /* inverse CDF of the density x^-exponent on [1,n+1) */
+    if( fabs( z->exponent-1 ) < 1e-9 )
+        x = exp( u*log( n+1 ) );
+    else
+        x = pow( 1 + u*(pow( n+1, 1-z->exponent ) - 1), 1/(1-z->exponent) );
+    low = (int)x - 1;
+    return low < 0 ? 0 : (low >= z->numSymbols ? z->numSymbols-1 : low);
+}
+
+/* generateZipfText
+ * input: the length of the text, the number of distinct lowercase letters (at most 26), the exponent, a seed
+ * output: a string of lowercase letters whose frequencies follow a Zipf law (this is malloc-ed so must be freed eventually!)
+ */
+char* generateZipfText( long length, int numSymbols, double exponent, uint64_t seed )
+{
+    ZipfGenerator* z = createZipfGenerator( numSymbols > 26 ? 26 : numSymbols, exponent, seed );
+    char* text = (char*)malloc( (length+1)*sizeof(char) );
+    long i;
+
+    for( i=0; i<length; i++ )
+        text[i] = 'a' + nextZipf( z );
+    text[length] = '\0';
+    freeZipfGenerator( z );
+    return text;
+}
+
+/* generateRandomWalk
+ * input: the number of moves, a seed
+ * output: an array of moves (this is malloc-ed so must be freed eventually!)
+ *
+ * Same step distribution as generateMoves in the driver (-250 to 250 in steps of 0.25)
+ */
+double* generateRandomWalk( long numMoves, uint64_t seed )
+{
+    double* moves = (double*)malloc( numMoves*sizeof(double) );
+    long i;
+
+    for( i=0; i<numMoves; i++ )
+        moves[i] = ((long)(nextRandom( &seed ) % 2001) - 1000) / 4.0;
+    return moves;
+}
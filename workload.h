@@ -0,0 +1,39 @@
+#ifndef _workload_h
+#define _workload_h
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#define ZIPF_TABLE_MAX (1<<20)  /* Zipf generators over at most this many symbols use an exact CDF table */
+
+typedef enum keyOrder { RANDOM_ORDER, SEQUENTIAL_ORDER, REVERSE_ORDER, SKEWED_ORDER } keyOrder;
+
+typedef struct ZipfGenerator
+{
+    int numSymbols;         /* symbols are 0..numSymbols-1, symbol 0 is the most frequent */
+    double exponent;        /* P(symbol k) is proportional to 1/(k+1)^exponent */
+    double* cdf;            /* cumulative probabilities (NULL above ZIPF_TABLE_MAX, which uses the continuous approximation) */
+    uint64_t state;         /* random number generator state */
+}  ZipfGenerator;
+
+/**********  Functions for generating random numbers **********/
+uint64_t nextRandom( uint64_t* state );
+double nextUniform( uint64_t* state );
+
+/**********  Functions for generating key orders **********/
+int* generateKeyOrder( int numKeys, keyOrder order, uint64_t seed );
+bool parseKeyOrder( char* name, keyOrder* pOrder );
+char* keyOrderName( keyOrder order );
+
+/**********  Functions for generating Zipfian streams **********/
+ZipfGenerator* createZipfGenerator( int numSymbols, double exponent, uint64_t seed );
+void freeZipfGenerator( ZipfGenerator* z );
+int nextZipf( ZipfGenerator* z );
+char* generateZipfText( long length, int numSymbols, double exponent, uint64_t seed );
+
+/**********  Functions for generating move sequences **********/
+double* generateRandomWalk( long numMoves, uint64_t seed );
+
+#endif